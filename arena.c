@@ -0,0 +1,94 @@
+#include "arena.h"
+#include "utils.h"
+
+//size of the header of a block, the memory of the block starts after it
+#define ARENA_HEADER_SIZE ((sizeof(arena_block_t) + ARENA_ALIGNMENT - 1) & ~(size_t) (ARENA_ALIGNMENT - 1))
+
+//internal functions
+arena_block_t* arena_block_create(size_t size);
+
+/**
+ * @return A new empty block with the given size
+ */
+arena_block_t* arena_block_create(size_t size){
+    arena_block_t* block;
+    MALLOC(block, ARENA_HEADER_SIZE + size, ;);
+    block -> next = NULL;
+    block -> size = size;
+    block -> used = 0;
+    return block;
+}
+
+/**
+ * Creates an empty arena
+ * @param block_size The size of the blocks allocated, a bigger block is used for bigger requests
+ * @return A pointer to the arena
+ */
+arena_t* arena_create(size_t block_size){
+    arena_t* arena;
+    MALLOC(arena, sizeof(arena_t), ;);
+    arena -> block_size = block_size > 0 ? block_size : ARENA_BLOCK_SIZE;
+    NULL_CHECK(arena -> first = arena_block_create(arena -> block_size));
+    arena -> current = arena -> first;
+    return arena;
+}
+
+/**
+ * Allocates memory from the current block, moving to the next one (or creating it) if it is full.
+ * The memory is not initialized
+ * @param arena The arena
+ * @param size The number of bytes
+ * @return A pointer aligned to ARENA_ALIGNMENT, valid until a rewind before it or arena_destroy
+ */
+void* arena_alloc(arena_t* arena, size_t size){
+    size = (size + ARENA_ALIGNMENT - 1) & ~(size_t) (ARENA_ALIGNMENT - 1);
+    arena_block_t* block = arena -> current;
+    while(block -> used + size > block -> size){
+        //the blocks after the current one are empty, a too small one is skipped by adding a new one before
+        if(block -> next == NULL || block -> next -> size < size){
+            arena_block_t* next;
+            NULL_CHECK(next = arena_block_create(size > arena -> block_size ? size : arena -> block_size));
+            next -> next = block -> next;
+            block -> next = next;
+        }
+        block = block -> next;
+        block -> used = 0;
+    }
+    arena -> current = block;
+    void* memory = (char*) block + ARENA_HEADER_SIZE + block -> used;
+    block -> used += size;
+    return memory;
+}
+
+/**
+ * @return The current position of the arena, to be used with arena_rewind
+ */
+arena_mark_t arena_mark(arena_t* arena){
+    arena_mark_t mark = {arena -> current, arena -> current -> used};
+    return mark;
+}
+
+/**
+ * Releases all the memory allocated after the mark, the blocks are kept for the next allocations
+ * @param arena The arena
+ * @param mark A position returned by arena_mark, not already released
+ */
+void arena_rewind(arena_t* arena, arena_mark_t mark){
+    arena -> current = mark.block;
+    arena -> current -> used = mark.used;
+}
+
+/**
+ * Frees all the blocks of the arena
+ */
+void arena_destroy(arena_t* arena){
+    if(arena != NULL){
+        arena_block_t* block = arena -> first;
+        while(block != NULL){
+            arena_block_t* next = block -> next;
+            FREE(block);
+            block = next;
+        }
+        FREE(arena);
+    }
+}
@@ -0,0 +1,43 @@
+/*
+ * Library implementing an arena (region) allocator for the temporary memory of a synthesis.
+ * Memory is taken from big blocks by moving a pointer and is never freed one object at a time:
+ * a mark saves the current position and rewinding to it releases everything allocated after,
+ * while the blocks are kept for the next allocations. All the blocks are freed by arena_destroy
+ */
+
+#ifndef DSOPP_SYNTHESIS_ARENA_H
+#define DSOPP_SYNTHESIS_ARENA_H
+
+#include <stddef.h>
+
+//default size of a block of the arena
+#define ARENA_BLOCK_SIZE (1 << 20)
+
+//alignment of the memory returned, enough for any type used in the library
+#define ARENA_ALIGNMENT 16
+
+typedef struct _arena_block{
+    struct _arena_block* next; //next block, possibly empty
+    size_t size; //bytes that can be allocated in the block
+    size_t used; //bytes allocated
+}arena_block_t;
+
+typedef struct{
+    arena_block_t* first; //first block of the list
+    arena_block_t* current; //block of the last allocation
+    size_t block_size; //minimum size of a new block
+}arena_t;
+
+//a position in the arena, to release all the memory allocated after it
+typedef struct{
+    arena_block_t* block;
+    size_t used;
+}arena_mark_t;
+
+arena_t* arena_create(size_t block_size); //creates an empty arena
+void* arena_alloc(arena_t*, size_t size); //returns memory valid until it is released
+arena_mark_t arena_mark(arena_t*); //returns the current position
+void arena_rewind(arena_t*, arena_mark_t); //releases the memory allocated after the mark
+void arena_destroy(arena_t*); //frees all the blocks
+
+#endif //DSOPP_SYNTHESIS_ARENA_H
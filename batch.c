@@ -0,0 +1,180 @@
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "batch.h"
+#include "portfolio.h"
+#include "utils.h"
+
+//the functions [start, end) left to a worker, it takes them from the start and the others steal from the end
+typedef struct{
+    size_t start;
+    size_t end;
+    pthread_mutex_t lock;
+}batch_share_t;
+
+//state of a batch, shared by the workers
+typedef struct{
+    fplus_t** functions;
+    batch_result_t* results;
+    unsigned engines;
+    bool dsopp;
+    batch_share_t* shares; //the share of each worker
+    unsigned workers; //size of above array
+}batch_t;
+
+//a worker of the pool
+typedef struct{
+    batch_t* batch;
+    unsigned id; //position of its share
+}batch_worker_t;
+
+//internal functions
+void* batch_worker(void* arg);
+bool batch_take(batch_t* batch, unsigned id, size_t* taken);
+bool batch_steal(batch_t* batch, unsigned id);
+void batch_run(batch_t* batch, size_t i);
+
+/**
+ * Synthesizes each function on a pool of threads (see batch.h), the calling thread is one of the workers
+ * @param functions The functions, NULL ones have a NULL form
+ * @param size The number of functions
+ * @param engines The PORTFOLIO_* engines to run, 0 for PORTFOLIO_GREEDY. With more than one engine each function
+ *          has a portfolio synthesis, with its own threads
+ * @param dsopp true to synthesize dsopp forms, else sopp forms
+ * @param threads The number of workers, 0 to use one for each online processor
+ * @return The results in the order of the functions, to be freed with batch_results_destroy. NULL on error
+ */
+batch_result_t* batch_synthesis(fplus_t** functions, size_t size, unsigned engines, bool dsopp, unsigned threads){
+    if(threads == 0) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = online > 0 ? (unsigned) online : 1;
+    }
+
+    batch_t batch;
+    batch.functions = functions;
+    batch.engines = engines == 0 ? PORTFOLIO_GREEDY : engines;
+    batch.dsopp = dsopp;
+    batch.workers = size == 0 ? 1 : threads < size ? threads : (unsigned) size;
+    batch.results = calloc(size > 0 ? size : 1, sizeof(batch_result_t));
+    NULL_CHECK(batch.results);
+    MALLOC(batch.shares, sizeof(batch_share_t) * batch.workers, FREE(batch.results));
+    batch_worker_t* jobs;
+    pthread_t* workers;
+    MALLOC(jobs, sizeof(batch_worker_t) * batch.workers, FREE(batch.shares); FREE(batch.results));
+    MALLOC(workers, sizeof(pthread_t) * batch.workers, FREE(jobs); FREE(batch.shares); FREE(batch.results));
+    for(unsigned w = 0; w < batch.workers; w++){
+        batch.shares[w].start = size * w / batch.workers;
+        batch.shares[w].end = size * (w + 1) / batch.workers;
+        pthread_mutex_init(&batch.shares[w].lock, NULL);
+    }
+
+    unsigned started = 0;
+    for(unsigned w = 0; w < batch.workers; w++){
+        jobs[w].batch = &batch;
+        jobs[w].id = w;
+    }
+    //the shares of the workers not started are stolen by the others
+    while(started + 1 < batch.workers && pthread_create(workers + started, NULL, batch_worker, jobs + started + 1) == 0)
+        started++;
+    batch_worker(jobs);
+    for(unsigned t = 0; t < started; t++)
+        pthread_join(workers[t], NULL);
+
+    for(unsigned w = 0; w < batch.workers; w++)
+        pthread_mutex_destroy(&batch.shares[w].lock);
+    FREE(workers);
+    FREE(jobs);
+    FREE(batch.shares);
+    return batch.results;
+}
+
+/**
+ * Synthesizes the functions of its share, then the ones stolen from the others, until none is left
+ * @param arg The batch_worker_t of the worker
+ * @return NULL
+ */
+void* batch_worker(void* arg){
+    batch_worker_t* worker = arg;
+    size_t i;
+    while(true){
+        if(batch_take(worker -> batch, worker -> id, &i))
+            batch_run(worker -> batch, i);
+        else if(!batch_steal(worker -> batch, worker -> id))
+            break;
+    }
+    return NULL;
+}
+
+/**
+ * Takes the first function left in the share of the worker
+ * @param taken Will store its position
+ * @return false if the share is empty
+ */
+bool batch_take(batch_t* batch, unsigned id, size_t* taken){
+    batch_share_t* share = batch -> shares + id;
+    pthread_mutex_lock(&share -> lock);
+    bool found = share -> start < share -> end;
+    if(found)
+        *taken = share -> start++;
+    pthread_mutex_unlock(&share -> lock);
+    return found;
+}
+
+/**
+ * Moves to the share of the worker, which is empty, the back half of the first share left of another worker.
+ * A range being moved by another thief is not seen, the worker may stop before all the functions are taken
+ * but they are all synthesized by the thief
+ * @return false if all the other shares are empty
+ */
+bool batch_steal(batch_t* batch, unsigned id){
+    for(unsigned k = 1; k < batch -> workers; k++){
+        batch_share_t* victim = batch -> shares + (id + k) % batch -> workers;
+        pthread_mutex_lock(&victim -> lock);
+        size_t left = victim -> end - victim -> start;
+        size_t start = victim -> end - (left + 1) / 2;
+        size_t end = victim -> end;
+        victim -> end = start;
+        pthread_mutex_unlock(&victim -> lock);
+        if(left > 0){
+            batch_share_t* share = batch -> shares + id;
+            pthread_mutex_lock(&share -> lock);
+            share -> start = start;
+            share -> end = end;
+            pthread_mutex_unlock(&share -> lock);
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Synthesizes the function in the given position and stores its form and time
+ */
+void batch_run(batch_t* batch, size_t i){
+    fplus_t* f = batch -> functions[i];
+    if(f == NULL)
+        return;
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    unsigned engines = batch -> engines;
+    if((engines & (engines - 1)) == 0){
+        bool optimal;
+        batch -> results[i].form = portfolio_engine(f, engines, batch -> dsopp, 0, NULL, &optimal);
+    } else
+        batch -> results[i].form = portfolio_synthesis(f, engines, batch -> dsopp, 0).form;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    batch -> results[i].seconds = (double) (end.tv_sec - start.tv_sec) + (double) (end.tv_nsec - start.tv_nsec) / 1e9;
+}
+
+/**
+ * Frees the results of a batch and their forms
+ * @param results The results
+ * @param size Their number
+ */
+void batch_results_destroy(batch_result_t* results, size_t size){
+    if(results != NULL){
+        for(size_t i = 0; i < size; i++)
+            sopp_destroy(results[i].form);
+        FREE(results);
+    }
+}
@@ -0,0 +1,24 @@
+/*
+ * Library implementing the synthesis of many functions at once on a fixed pool of threads. Each worker starts
+ * with a contiguous share of the functions and takes them from the front; a worker left without functions
+ * steals the back half of the share of another one, so that a few slow functions do not keep the others idle.
+ * The syntheses do not share any state, so the forms are the same found one function at a time
+ */
+
+#ifndef DSOPP_SYNTHESIS_BATCH_H
+#define DSOPP_SYNTHESIS_BATCH_H
+
+#include "bool_plus.h"
+
+//the result of the synthesis of a function of a batch
+typedef struct{
+    sopp_t* form; //the form found, NULL on error
+    double seconds; //time taken by the synthesis
+}batch_result_t;
+
+//synthesizes each function with the given engines (a mask of PORTFOLIO_*) on a pool of threads,
+//returns the results in the order of the functions
+batch_result_t* batch_synthesis(fplus_t** functions, size_t size, unsigned engines, bool dsopp, unsigned threads);
+void batch_results_destroy(batch_result_t*, size_t size); //frees the results and their forms
+
+#endif //DSOPP_SYNTHESIS_BATCH_H
@@ -1,20 +1,107 @@
 #include <stdlib.h>
 #include <time.h>
 #include <string.h>
-#include <math.h>
 #include <limits.h>
+#include <unistd.h>
+#include <pthread.h>
 #include "utils.h"
-#include "linkedlist.h"
+#include "pqueue.h"
+#include "prng.h"
+#include "greedy.h"
+#include "cubeset.h"
+#include "primes.h"
+#include "espresso.h"
+#include "exact.h"
+#include "portfolio.h"
+
+//chunk of a class joined by a worker of prime_implicants_wthreads
+typedef struct{
+    unsigned k; //class of the cubes
+    size_t start; //first cube of the chunk
+    size_t end; //cube after the last of the chunk
+    cube_t* joins; //implicants found joining the cubes of the chunk
+    size_t joins_size; //number of implicants found
+    size_t joins_max; //size of above array
+}join_chunk_t;
+
+//state of a cycle of prime_implicants_wthreads, shared by the workers
+typedef struct{
+    fplus_t* f;
+    cubeset_t** classes; //cubes of the cycle, classes[k] has the cubes with k positive literals
+    unsigned n_classes; //size of above array
+    size_t* class_start; //offset of each class in taken
+    bool* taken; //stores if a cube has been joined at least one time with another
+    bool first_cycle;
+    join_chunk_t* chunks; //work to do
+    size_t n_chunks; //size of above array
+    size_t next_chunk; //first chunk not yet taken by a worker
+    bool failed; //set by a worker that could not store a join
+    pthread_mutex_t lock; //protects next_chunk and failed
+}join_work_t;
+
+//state of sopp_dense_form_of, shared by the workers
+typedef struct{
+    productp_t** products; //the products of the form
+    size_t size; //size of above array
+    fplus_t* f;
+    bool disjoint; //true to check a dsopp form
+    unsigned shift; //variables of a slice, slice s has the points with (point >> shift) == s
+    size_t n_slices; //number of slices
+    size_t next_slice; //first slice not yet taken by a worker
+    bool result; //set to false as soon as a slice is not valid
+    pthread_mutex_t lock; //protects next_slice and result
+}form_work_t;
+
+//state of fplus_random_dense, shared by the workers
+typedef struct{
+    fplus_t* f; //the function filled, its values are wide enough for max_value
+    int max_value;
+    unsigned non_zero_chance;
+    unsigned undefined_chance;
+    uint64_t seed;
+    unsigned shift; //variables of a chunk, chunk c has the points with (point >> shift) == c
+    size_t n_chunks; //number of chunks
+    size_t* chunk_sizes; //points of each chunk added to non_zeros, from the position of its first point
+    size_t next_chunk; //first chunk not yet taken by a worker
+    pthread_mutex_t lock; //protects next_chunk
+}random_work_t;
+
+//a sopp synthesis used for the rounds of a dsopp synthesis
+typedef sopp_t* (*round_synthesis_t)(fplus_t* f, budget_t* budget, arena_t* arena);
 
 //internal functions
-void sopp_binaries(bool *value, unsigned i, sopp_t *sop, fplus_t* fun, bool *result);
-void dsopp_binaries(bool *value, unsigned i, dsopp_t *sop, fplus_t* fun, bool *result);
-bvector joinable_vectors(const bool*, const bool*, unsigned variables);
-productp_t** implicants2sop(bvector*, int size, unsigned variables, int* final_size);
-long product_hashcode(productp_t *p);
-bool r_cover_s(const int *r_indexes, int r_size, int *s_indexes, int s_size, fplus_t *f, int* non_zero_values);
-void my_quicksort(bvector* arr, int low, int high, unsigned variables, int* norms);
-int free_f(void* p, size_t* s);
+bool sopp_dense_form_of(sopp_t* sopp, fplus_t* fun, bool disjoint, unsigned threads);
+void* form_worker(void* arg);
+bool form_check_slice(form_work_t* work, size_t slice, long* sums);
+void sopp_values_block(productp_t** products, size_t size, const cword_t* slices, unsigned variables,
+                       size_t words, size_t first, size_t count, long* sums);
+productp_t** implicants2sop(cube_t**, int size, unsigned variables, int* final_size);
+size_t* sopp_slot(sopp_t* sopp, cube_t c);
+bool sopp_grow(sopp_t* sopp);
+void* join_worker(void* arg);
+bool join_chunk(join_work_t* work, join_chunk_t* chunk);
+void join_classes_destroy(cubeset_t** classes, cubeset_t** next_classes, unsigned n_classes);
+bool cubes_append(cube_t** array, size_t* size, size_t* max_size, cube_t c);
+void fplus_cube_sub(fplus_t* f, cube_t c, int decrement, bool disjoint);
+void fplus_sparse_cube_values(fplus_t* f, cube_t c, unsigned* max, unsigned* min, bool* zeros, bool* all_dont_care);
+bool remove_implicant_duplicates_wbudget_warena(implicants_t* source, implicants_t* to_remove, fplus_t* f,
+                                                budget_t* budget, arena_t* arena);
+long fplus_insert(fplus_t* f, point_t index);
+int fplus_value_in(fplus_t* f, size_t position);
+bool sopp_sparse_form_of(sopp_t* sopp, fplus_t* fun, bool disjoint);
+bool sopp_complete(sopp_t* sopp, fplus_t* f);
+sopp_t* sopp_synthesis_wbudget_warena(fplus_t* f, budget_t* budget, arena_t* arena);
+sopp_t* sopp_synthesis_experimental_wbudget_warena(fplus_t* f, budget_t* budget, arena_t* arena);
+sopp_t* sopp_synthesis_failed(sopp_t* sopp, fplus_t* f_copy, primes_t* primes, implicants_t* implicants,
+                              implicants_t* i_copy);
+dsopp_t* dsopp_synthesis_wbudget_warena(fplus_t* f, budget_t* budget, arena_t* arena);
+dsopp_t* dsopp_synthesis_wexperimental_wbudget_warena(fplus_t* f, budget_t* budget, arena_t* arena);
+dsopp_t* dsopp_rounds(fplus_t* f, sopp_t* first, round_synthesis_t next, budget_t* budget, arena_t* arena);
+sopp_t* dsopp_heuristic_round(fplus_t* f, budget_t* budget, arena_t* arena);
+fplus_t* fplus_random_dense(unsigned variables, int max_value, unsigned non_zero_chance, unsigned undefined_chance,
+                           uint64_t seed, unsigned threads);
+void* random_worker(void* arg);
+void random_fill_chunk(random_work_t* work, size_t chunk);
 
 /**
  * Creates a sopp with a default size
@@ -26,24 +113,58 @@ sopp_t* sopp_create(){
 
 /**
  * Tries to create the sopp with a table of the suggested size.
- * Note: sopp table will have at most suggested_size / good_load constant, possibly lower
- * Creates the sopp form keeping in mind the expected number of products
+ * Note: the table starts with at least expected_size / GOOD_LOAD slots, possibly lower
+ * if the memory is not available, and grows when needed
  * @param expected_size The expected number of products
  * @return A pointer to the sopp
  */
 sopp_t* sopp_create_wsize(size_t expected_size){
     sopp_t* sopp;
     MALLOC(sopp, sizeof(sopp_t), ;);
-    int good_size = (int) (expected_size / GOOD_LOAD) + 1; //always greater than 0
-    while((sopp -> table = malloc(sizeof(alist_t*) * good_size)) == NULL)
+    size_t good_size = 16;
+    while(good_size * GOOD_LOAD < expected_size)
+        good_size *= 2;
+    while((sopp -> table = malloc(sizeof(size_t) * good_size)) == NULL && good_size > 16)
         good_size /= 2;
-    memset(sopp -> table, 0, sizeof(alist_t*) * good_size);
+    NULL_CHECK(sopp -> table);
+    memset(sopp -> table, 0, sizeof(size_t) * good_size);
     sopp -> table_size = good_size;
     sopp -> current_length = 0;
     NULL_CHECK(sopp -> arraylist = alist_create());
     return sopp;
 }
 
+/**
+ * @return The slot of the table containing the product with the given cube or the empty slot
+ *      where it should be stored
+ */
+size_t* sopp_slot(sopp_t* sopp, cube_t c){
+    productp_t** products = alist_as_array(sopp -> arraylist, NULL);
+    size_t mask = sopp -> table_size - 1;
+    size_t i = cube_hashcode(c) & mask;
+    while(sopp -> table[i] != 0 && !cube_equals(products[sopp -> table[i] - 1] -> b_product.cube, c))
+        i = (i + 1) & mask;
+    return sopp -> table + i;
+}
+
+/**
+ * Doubles the size of the table, then rehashes all the products
+ * @return The outcome of the operation
+ */
+bool sopp_grow(sopp_t* sopp){
+    size_t* new_table;
+    size_t new_size = sopp -> table_size * 2;
+    MALLOC(new_table, sizeof(size_t) * new_size, ;);
+    memset(new_table, 0, sizeof(size_t) * new_size);
+    FREE(sopp -> table);
+    sopp -> table = new_table;
+    sopp -> table_size = new_size;
+    productp_t** products = alist_as_array(sopp -> arraylist, NULL);
+    for(size_t i = 0; i < sopp -> current_length; i++)
+        *sopp_slot(sopp, products[i] -> b_product.cube) = i + 1;
+    return true;
+}
+
 /**
  * Adds a product plus to the sopp form, if the product is already in the form,
  * its coefficient is updated. The product is always copied before storage
@@ -52,59 +173,28 @@ sopp_t* sopp_create_wsize(size_t expected_size){
  * @return The outcome of the operation
  */
 bool sopp_add(sopp_t* sopp, productp_t* p){
-    unsigned long hashcode = product_hashcode(p) % sopp -> table_size;
-
-    if((double) (sopp -> current_length + 1) / sopp -> table_size > GOOD_LOAD)
-        fprintf(stdout,
-                "Warning: sopp table is exceeding good load, current size is %ld while max size is %ld\n",
-                sopp -> current_length, sopp -> table_size);
-
-    productp_t* product = productp_copy(p);
-
-    //if list is empty
-    if(sopp -> table[hashcode] == NULL){
-        NULL_CHECK(sopp -> table[hashcode] = alist_create());
-        alist_add(sopp->table[hashcode], product, sizeof(productp_t *));
-        alist_add(sopp->arraylist, product, sizeof(productp_t *));
-        sopp -> current_length++;
-        return true;
-    }
-
-    //list not empty, check existence
-    size_t size;
-    productp_t** array = alist_as_array(sopp->table[hashcode], &size);
-    size_t i = 0;
-    while(i < size && !bvector_equals(array[i] -> b_product -> product, product -> b_product -> product, product -> b_product -> variables))
-        i++;
-    if(i < size) {
+    size_t* slot = sopp_slot(sopp, p -> b_product.cube);
+    if(*slot != 0) {
         //element was found, update value
-        array[i]->coeff += product->coeff;
-        productp_destroy(product);
+        productp_t** products = alist_as_array(sopp -> arraylist, NULL);
+        products[*slot - 1] -> coeff += p -> coeff;
         return true;
     }
+
     //element was not found
-    alist_add(sopp->table[hashcode], product, sizeof(productp_t *));
+    if(sopp -> current_length + 1 > sopp -> table_size * GOOD_LOAD){
+        if(!sopp_grow(sopp))
+            return false;
+        slot = sopp_slot(sopp, p -> b_product.cube);
+    }
+    productp_t* product = productp_copy(p);
+    NULL_CHECK(product);
     alist_add(sopp->arraylist, product, sizeof(productp_t *));
     sopp -> current_length++;
+    *slot = sopp -> current_length;
     return true;
 }
 
-/**
- * Given a product plus, it returns an hashcode based on its values
- * semi stolen from java, may be improved
- * @param p The product plus
- * @return The hash code
- */
-long product_hashcode(productp_t *p) {
-    long hashcode = 0;
-    unsigned n = p -> b_product -> variables;
-    for(int i = 0; i < n; i++){
-        hashcode += (long) pow(p -> b_product -> product[i] * 31, n - i);
-    }
-
-    return hashcode;
-}
-
 /**
  * Checks if the sop plus for the given input equals the value
  * @return true if the output matches
@@ -115,44 +205,286 @@ int sopp_value_of(sopp_t* sop, bool input[]){
     productp_t** list = alist_as_array(sop->arraylist, &size);
     for(size_t i = 0; i < size; i++){
         productp_t* current_p = list[i];
-        sopp_value += current_p->coeff * product_of(current_p -> b_product, input);
+        sopp_value += current_p->coeff * product_of(&current_p -> b_product, input);
     }
     return sopp_value;
 }
 
+/**
+ * Evaluates the sopp on many inputs at a time. The inputs are bit sliced: for each variable
+ * a row of (count + 63) / 64 words, where bit k of word w is the value of the variable in input
+ * w * 64 + k. Each product is evaluated on 64 inputs at a time with a few logical operations
+ * per literal, then its coefficient is added to the sums of the inputs covered
+ * @param sopp The sopp (or dsopp) form
+ * @param slices The rows, one for each variable, in the order of the variables (as in sopp_value_of)
+ * @param variables The number of variables, equal to the ones of the products
+ * @param count The number of inputs
+ * @param sums Array of count elements, will store the output of the sopp for each input
+ */
+void sopp_values_of(sopp_t* sopp, const cword_t* slices, unsigned variables, size_t count, long* sums){
+    size_t size = 0;
+    productp_t** products = alist_as_array(sopp -> arraylist, &size);
+    size_t words = (count + CWORD_BITS - 1) / CWORD_BITS;
+    memset(sums, 0, sizeof(long) * count);
+    for(size_t w = 0; w < words; w += EVAL_BLOCK_WORDS){
+        size_t first = w * CWORD_BITS;
+        size_t block = count - first < EVAL_BLOCK_WORDS * CWORD_BITS ? count - first : EVAL_BLOCK_WORDS * CWORD_BITS;
+        sopp_values_block(products, size, slices, variables, words, first, block, sums);
+    }
+}
+
+/**
+ * Adds the coefficients of the products to the sums of a block of up to EVAL_BLOCK_WORDS words of inputs
+ * @param products The products
+ * @param size Size of above array
+ * @param slices The bit slices of all the inputs
+ * @param variables The number of variables, one row of slices each
+ * @param words The number of words of each row of slices
+ * @param first The first input of the block, a multiple of CWORD_BITS
+ * @param count The number of inputs of the block
+ * @param sums The outputs of all the inputs
+ */
+void sopp_values_block(productp_t** products, size_t size, const cword_t* slices, unsigned variables,
+                       size_t words, size_t first, size_t count, long* sums){
+    size_t w0 = first / CWORD_BITS;
+    size_t block_words = (count + CWORD_BITS - 1) / CWORD_BITS;
+    cword_t covered[EVAL_BLOCK_WORDS];
+    for(size_t p = 0; p < size; p++){
+        cube_t c = products[p] -> b_product.cube;
+        for(size_t w = 0; w < EVAL_BLOCK_WORDS; w++)
+            covered[w] = w < block_words ? ~(cword_t) 0 : 0;
+
+        //a literal keeps the inputs where the variable has the value of the literal
+        for(cword_t care = c.care; care != 0; care &= care - 1){
+            unsigned bit = (unsigned) __builtin_ctzll(care);
+            const cword_t* row = slices + (size_t) (variables - bit - 1) * words + w0;
+            cword_t flip = (c.value >> bit) & 1 ? 0 : ~(cword_t) 0;
+            for(size_t w = 0; w < block_words; w++)
+                covered[w] &= row[w] ^ flip;
+        }
+
+        //inputs after count in the last word are not valid
+        if(count % CWORD_BITS != 0)
+            covered[block_words - 1] &= CUBE_MASK(count % CWORD_BITS);
+        for(size_t w = 0; w < block_words; w++)
+            for(cword_t bits = covered[w]; bits != 0; bits &= bits - 1)
+                sums[first + w * CWORD_BITS + __builtin_ctzll(bits)] += products[p] -> coeff;
+    }
+}
+
+/**
+ * Evaluates the sopp on many inputs given as decimals, see sopp_values_of.
+ * The inputs are converted to bit slices 64 at a time
+ * @param sopp The sopp (or dsopp) form
+ * @param points The inputs as decimals
+ * @param variables The number of variables, equal to the ones of the products
+ * @param count The number of inputs
+ * @param sums Array of count elements, will store the output of the sopp for each input
+ * @return The outcome of the operation
+ */
+bool sopp_values_at(sopp_t* sopp, const point_t* points, unsigned variables, size_t count, long* sums){
+    size_t block = EVAL_BLOCK_WORDS * CWORD_BITS;
+    cword_t* slices;
+    MALLOC(slices, sizeof(cword_t) * EVAL_BLOCK_WORDS * (variables > 0 ? variables : 1), ;);
+    for(size_t first = 0; first < count; first += block){
+        size_t n = count - first < block ? count - first : block;
+        size_t words = (n + CWORD_BITS - 1) / CWORD_BITS;
+        memset(slices, 0, sizeof(cword_t) * words * variables);
+        for(size_t k = 0; k < n; k++){
+            point_t point = points[first + k];
+            for(unsigned i = 0; i < variables; i++)
+                slices[i * words + k / CWORD_BITS] |= ((point >> (variables - i - 1)) & 1) << (k % CWORD_BITS);
+        }
+        sopp_values_of(sopp, slices, variables, n, sums + first);
+    }
+    FREE(slices);
+    return true;
+}
+
 /**
  * Checks if sopp_t is a correct sop plus form of the function fun
- * time: exponential in number of variables
+ * time: linear in the points of the function plus the points covered by the products
+ * (only the latter if sparse)
  * @return true it is valid
  */
 bool sopp_form_of(sopp_t* sopp, fplus_t* fun){
-    unsigned length = fun -> variables;
-    bool value[length];
-    memset(value, 0, sizeof(bool) * length);
-    bool result = true;
-    sopp_binaries(value, length, sopp, fun, &result);
-    return result;
+    return sopp_form_of_wthreads(sopp, fun, 1);
+}
+
+/**
+ * Same as sopp_form_of, a dense function is checked by more threads
+ * @param threads The number of threads, 0 to use one for each online processor
+ * @return true it is valid
+ */
+bool sopp_form_of_wthreads(sopp_t* sopp, fplus_t* fun, unsigned threads){
+    if(fun -> sparse != NULL)
+        return sopp_sparse_form_of(sopp, fun, false);
+    return sopp_dense_form_of(sopp, fun, false, threads);
 }
 
-/*
- * rec-fun called by sopp_form_of
- *
- * generates all the possible combinations of the variables
- * and checks if the non zero values of the fun matches the non zero values
- * of the sop plus form
+/**
+ * Checks a sopp or dsopp form of a dense function. The domain is split in slices of
+ * 2^FORM_SLICE_VARIABLES points: for each slice the coefficients of the products intersecting it
+ * are summed in the points they cover, then the sums are compared with the values of the slice.
+ * A sopp form is valid if each non zero point has a sum not lower than its value, a dsopp form
+ * if each point has a sum equal to its value (so a don't care point makes it not valid)
+ * @param sopp The sopp or dsopp form
+ * @param fun A dense function
+ * @param disjoint true to check a dsopp form, false for a sopp form
+ * @param threads The number of threads checking the slices, 0 to use one for each online processor
+ * @return true if it is valid
  */
-void sopp_binaries(bool *value, unsigned i, sopp_t* sop, fplus_t* fun, bool* result) {
-    if(*result) {
-        if (i == 0) {
-            int fvalue = fplus_value_of(fun, value);
-            *result = *result && (fvalue == 0 || sopp_value_of(sop, value) >= fvalue);
-        } else {
-            value[i - 1] = 0;
-            sopp_binaries(value, i - 1, sop, fun, result);
-            value[i - 1] = 1;
-            sopp_binaries(value, i - 1, sop, fun, result);
+bool sopp_dense_form_of(sopp_t* sopp, fplus_t* fun, bool disjoint, unsigned threads){
+    if(threads == 0) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = online > 0 ? (unsigned) online : 1;
+    }
+
+    form_work_t work;
+    work.products = alist_as_array(sopp -> arraylist, &work.size);
+    work.f = fun;
+    work.disjoint = disjoint;
+    work.shift = fun -> variables < FORM_SLICE_VARIABLES ? fun -> variables : FORM_SLICE_VARIABLES;
+    work.n_slices = (size_t) 1 << (fun -> variables - work.shift);
+    work.next_slice = 0;
+    work.result = true;
+    pthread_mutex_init(&work.lock, NULL);
+
+    unsigned n_workers = threads < work.n_slices ? threads : (unsigned) work.n_slices;
+    pthread_t workers[n_workers];
+    unsigned started = 0;
+    while (started + 1 < n_workers && pthread_create(workers + started, NULL, form_worker, &work) == 0)
+        started++;
+    form_worker(&work);
+    for (unsigned t = 0; t < started; t++)
+        pthread_join(workers[t], NULL);
+
+    pthread_mutex_destroy(&work.lock);
+    return work.result;
+}
+
+/**
+ * Checks slices until there are none left or one is not valid
+ * @param arg The shared form_work_t
+ */
+void* form_worker(void* arg){
+    form_work_t* work = arg;
+    long* sums; //sums of the products in the points of the slice
+    MALLOC(sums, sizeof(long) * ((size_t) 1 << work -> shift),
+           pthread_mutex_lock(&work -> lock); work -> result = false; pthread_mutex_unlock(&work -> lock));
+    while (true) {
+        pthread_mutex_lock(&work -> lock);
+        size_t slice = work -> next_slice++;
+        bool go_on = work -> result;
+        pthread_mutex_unlock(&work -> lock);
+        if (slice >= work -> n_slices || !go_on)
+            break;
+        if (!form_check_slice(work, slice, sums)) {
+            pthread_mutex_lock(&work -> lock);
+            work -> result = false;
+            pthread_mutex_unlock(&work -> lock);
         }
     }
+    FREE(sums);
+    return NULL;
+}
+
+/**
+ * Sums the coefficients of the products in the points of the slice, then compares them with the function
+ * @param work The shared state
+ * @param slice The slice to check
+ * @param sums An array of 2^shift elements
+ * @return true if the form is valid in the points of the slice
+ */
+bool form_check_slice(form_work_t* work, size_t slice, long* sums){
+    size_t slice_size = (size_t) 1 << work -> shift;
+    cword_t low = CUBE_MASK(work -> shift); //variables inside the slice
+    cword_t prefix = (cword_t) slice << work -> shift;
+    memset(sums, 0, sizeof(long) * slice_size);
+
+    for (size_t i = 0; i < work -> size; i++) {
+        cube_t c = work -> products[i] -> b_product.cube;
+        int coeff = work -> products[i] -> coeff;
+        //skips the products with a literal of the variables outside the slice not matching it
+        if (coeff == 0 || ((c.value ^ prefix) & c.care & ~low) != 0)
+            continue;
+        cword_t free_vars = ~c.care & low;
+        cword_t value = c.value & low;
+        cword_t subset = 0;
+        do {
+            sums[value | subset] += coeff;
+            subset = (subset - free_vars) & free_vars;
+        } while (subset != 0);
+    }
+
+    fvalues_t* values = work -> f -> values;
+    for (size_t i = 0; i < slice_size; i++) {
+        size_t point = prefix | i;
+        long fvalue = fvalues_get(values, point);
+        if (fvalues_is_dont_care(values, point)) {
+            if (work -> disjoint)
+                return false;
+        } else if (work -> disjoint ? sums[i] != fvalue : fvalue != 0 && sums[i] < fvalue)
+            return false;
+    }
+    return true;
+}
+
+/**
+ * Checks a sopp or dsopp form of a sparse function: the coefficients of the products are summed
+ * in the points they cover, then the sums are compared with the values of the function as done
+ * by sopp_dense_form_of. For a dsopp form, a product covering a point
+ * not stored (with value 0) makes the form not valid
+ * @param sopp The sopp or dsopp form
+ * @param fun A sparse function
+ * @param disjoint true to check a dsopp form, false for a sopp form
+ * @return true if it is valid
+ */
+bool sopp_sparse_form_of(sopp_t* sopp, fplus_t* fun, bool disjoint){
+    size_t f_size = fplus_size(fun);
+    long* sums; //sums[i] is the value of the form in the point stored in position i
+    MALLOC(sums, sizeof(long) * (f_size > 0 ? f_size : 1), ;);
+    memset(sums, 0, sizeof(long) * f_size);
+
+    bool result = true;
+    size_t size;
+    productp_t** products = alist_as_array(sopp -> arraylist, &size);
+    for(size_t i = 0; result && i < size; i++){
+        if(products[i] -> coeff == 0)
+            continue;
+        cube_t c = products[i] -> b_product.cube;
+        cword_t free_vars = ~c.care & CUBE_MASK(fun -> variables);
+        int free_count = __builtin_popcountll(free_vars);
+        if(free_count >= CWORD_BITS - 1 || (size_t) 1 << free_count > f_size){
+            //covers more points than those stored, so some with value 0
+            result = !disjoint;
+            for(size_t j = 0; result && j < f_size; j++)
+                if(cube_covers(c, fplus_point_at(fun, j)))
+                    sums[j] += products[i] -> coeff;
+            continue;
+        }
+        cword_t subset = 0;
+        do{
+            long index = fplus_index_of(fun, c.value | subset);
+            if(index >= 0)
+                sums[index] += products[i] -> coeff;
+            else if(disjoint)
+                result = false;
+            subset = (subset - free_vars) & free_vars;
+        }while(result && subset != 0);
+    }
+
+    for(size_t i = 0; result && i < f_size; i++){
+        long fvalue = fvalues_get(fun -> values, i);
+        if(fvalues_is_dont_care(fun -> values, i))
+            result = !disjoint; //as done for dense functions, a don't care is never matched
+        else if(disjoint)
+            result = sums[i] == fvalue;
+        else
+            result = fvalue == 0 || sums[i] >= fvalue;
+    }
+    FREE(sums);
+    return result;
 }
 
 /**
@@ -165,12 +497,7 @@ void sopp_print(sopp_t* s){
     printf("Sopp form is: \n");
     for(size_t i = 0; i < size; i++){
         printf("Product has coeff: %d and is: ", (array[i]) -> coeff);
-        for(int j = 0; j < array[0] -> b_product -> variables; j++){
-            if(array[i] -> b_product -> product[j] > 1)
-                printf("- ");
-            else
-                printf("%d ", array[i] -> b_product -> product[j]);
-        }
+        cube_print(array[i] -> b_product.cube, array[i] -> b_product.variables, ' ');
         printf("\n");
     }
 }
@@ -188,15 +515,38 @@ void sopp_destroy(sopp_t* sopp){
         }
 
         alist_destroy(sopp->arraylist);
-        for (size_t i = 0; i < sopp->table_size; i++) {
-            if (sopp->table[i] != NULL)
-                alist_destroy(sopp->table[i]);
-        }
         FREE(sopp->table);
         FREE(sopp);
     }
 }
 
+/**
+ * Completes a form whose synthesis was stopped: each point whose output is greater than the value of
+ * the form gets a minterm with the difference as coefficient. A sopp form of the function is obtained,
+ * and a dsopp one if the form was never above the outputs and the function has no don't care points
+ * @param sopp The sopp or dsopp form
+ * @param f The function
+ * @return The outcome of the operation
+ */
+bool sopp_complete(sopp_t* sopp, fplus_t* f){
+    if(f -> nz_size == 0)
+        return true;
+    long* sums;
+    MALLOC(sums, sizeof(long) * f -> nz_size, ;);
+    bool done = sopp_values_at(sopp, f -> non_zeros, f -> variables, f -> nz_size, sums);
+    for(size_t i = 0; i < f -> nz_size && done; i++){
+        int value = fplus_value_at(f, f -> non_zeros[i]);
+        if(value <= sums[i])
+            continue;
+        productp_t* p = productp_create(cube_of_point(f -> non_zeros[i], f -> variables), f -> variables,
+                                        (int) (value - sums[i]));
+        done = p != NULL && sopp_add(sopp, p);
+        productp_destroy(p);
+    }
+    FREE(sums);
+    return done;
+}
+
 /**
  * Calculates a (reasonably) minimal sopp form for the given function
  * sopp form is minimal <=> the sum of its coefficients is minimal
@@ -204,19 +554,77 @@ void sopp_destroy(sopp_t* sopp){
  * @return The minimal sopp form
  */
 sopp_t* sopp_synthesis(fplus_t* f){
+    arena_t* arena;
+    NULL_CHECK(arena = arena_create(ARENA_BLOCK_SIZE));
+    sopp_t* sopp = sopp_synthesis_warena(f, arena);
+    arena_destroy(arena);
+    return sopp;
+}
+
+/**
+ * Same as sopp_synthesis, the temporary memory is allocated in the arena
+ * @param f A fplus function
+ * @param arena The arena, the memory taken is released before returning
+ * @return The minimal sopp form, not in the arena
+ */
+sopp_t* sopp_synthesis_warena(fplus_t* f, arena_t* arena){
+    return sopp_synthesis_wbudget_warena(f, NULL, arena);
+}
+
+/**
+ * Same as sopp_synthesis, the synthesis stops when the budget is over and completes the form found
+ * @param f A fplus function
+ * @param budget The budget, NULL for no limit
+ * @return The sopp form found
+ */
+sopp_t* sopp_synthesis_wbudget(fplus_t* f, budget_t* budget){
+    arena_t* arena;
+    NULL_CHECK(arena = arena_create(ARENA_BLOCK_SIZE));
+    sopp_t* sopp = sopp_synthesis_wbudget_warena(f, budget, arena);
+    arena_destroy(arena);
+    return sopp;
+}
+
+/**
+ * Same as sopp_synthesis, the temporary memory is allocated in the arena. The budget is checked at each
+ * round of the essential implicants, at each implicant chosen and while finding the implicants:
+ * when it is over, the points not yet reached are covered by minterms
+ * @param f A fplus function
+ * @param budget The budget, NULL for no limit
+ * @param arena The arena, the memory taken is released before returning
+ * @return The sopp form found, not in the arena
+ */
+sopp_t* sopp_synthesis_wbudget_warena(fplus_t* f, budget_t* budget, arena_t* arena){
     sopp_t* sopp; //will store the minimal sopp form
     implicants_t* implicants; //will store prime implicants
     bool go_on;
 
     NULL_CHECK(sopp = sopp_create_wsize(f -> nz_size));
-    NULL_CHECK(implicants = prime_implicants(f));
 
     fplus_t* f_copy = fplus_copy(f);
+    if(f_copy == NULL)
+        return sopp_synthesis_failed(sopp, NULL, NULL, NULL, NULL);
+    primes_t* primes; //kept up to date while the values of f_copy decrease
+    if((primes = primes_create_wbudget(f_copy, budget)) == NULL && budget_over(budget)){
+        //stopped before finding the implicants, all the points are covered by minterms
+        fplus_copy_destroy(f_copy);
+        if(!sopp_complete(sopp, f)){
+            sopp_destroy(sopp);
+            return NULL;
+        }
+        return sopp;
+    }
+    if(primes == NULL)
+        return sopp_synthesis_failed(sopp, f_copy, NULL, NULL, NULL);
+    if((implicants = primes_implicants(primes)) == NULL)
+        return sopp_synthesis_failed(sopp, f_copy, primes, NULL, NULL);
     implicants_t* i_copy = implicants_copy(implicants);
+    if(i_copy == NULL)
+        return sopp_synthesis_failed(sopp, f_copy, primes, implicants, NULL);
 
     essentialsp_t* e;
     do {
-        if((e = essential_implicants(f_copy, i_copy)) == NULL)
+        if(budget_over(budget) || (e = essential_implicants_warena(f_copy, i_copy, arena)) == NULL)
             break;
         if(e->points_size == 0){
             essentials_destroy(e);
@@ -226,8 +634,8 @@ sopp_t* sopp_synthesis(fplus_t* f){
         for (int i = 0; i < e -> impl_size; i++) {
             int max = 0;
             for (int j = 0; j < e -> points_size; j++) {
-                if (product_of(e -> implicants[i]->b_product, e->points[j])) {
-                    int cur_value = fplus_value_of(f_copy , e->points[j]);
+                if (cube_covers(e -> implicants[i]->b_product.cube, e->points[j])) {
+                    int cur_value = fplus_value_at(f_copy , e->points[j]);
                     if (cur_value > max)
                         max = cur_value;
                 }
@@ -241,69 +649,52 @@ sopp_t* sopp_synthesis(fplus_t* f){
         //for each implicant chosen update f values
         productp_t** impls = alist_as_array(sopp->arraylist, NULL);
         for(size_t i = 0; i < sopp -> current_length; i++) {
-            int size;
-            int *indexes = binary2decimals(impls[i] ->b_product->product, impls[i] -> b_product -> variables, &size);
-            for (int j = 0; j < size; j++) {
-                fplus_sub2value_sopp(f_copy, indexes[j], impls[i]->coeff);
-            }
-            FREE(indexes);
+            fplus_cube_sub_sopp(f_copy, impls[i] -> b_product.cube, impls[i] -> coeff);
+            primes_update(primes, impls[i] -> b_product.cube);
         }
 
         fplus_update_non_zeros(f_copy);
-        implicants_t *new_implicants = prime_implicants(f_copy);
-        go_on = remove_implicant_duplicates(i_copy, new_implicants, f_copy) && i_copy -> size > 0;
-        implicants_soft_destroy(new_implicants);
+        implicants_t *new_implicants = primes_implicants(primes);
+        if(new_implicants == NULL){
+            essentials_destroy(e);
+            return sopp_synthesis_failed(sopp, f_copy, primes, implicants, i_copy);
+        }
+        go_on = remove_implicant_duplicates_wbudget_warena(i_copy, new_implicants, f_copy, budget, arena) &&
+                i_copy -> size > 0;
+        implicants_destroy(new_implicants);
 
         essentials_destroy(e);
     }while(go_on);
 
-    while(i_copy -> size > 0) {
-        int min = INT_MAX;
-        int implicant_chosen = -1;
-
-        //select the implicant to add
-        for (int i = 0; i < i_copy->size; i++) {
-            int max = 0;
-            int size;
-            int *indexes = binary2decimals(i_copy->bvectors[i], i_copy->variables, &size);
-            for (int j = 0; j < size; j++) {
-                int c_value = fplus_value_at(f_copy, indexes[j]);
-                if (c_value > 0 && c_value > max) {
-                    max = c_value;
-                }
-            }
-            if (max > 0 && max < min) {
-                min = max;
-                implicant_chosen = i;
-            }
-            FREE(indexes);
-        }
-        if(implicant_chosen == -1)
-            break;
-        productp_t* p = productp_create(i_copy -> bvectors[implicant_chosen], i_copy -> variables, min);
-
-        //change the dashed into not_present
-        for(int k = 0; k < f -> variables; k++)
-            if(p -> b_product -> product[k] == dash)
-                p -> b_product -> product[k] = not_present;
-        sopp_add(sopp, p);
-        productp_destroy(p);
-
-        int size;
-        int *indexes = binary2decimals(i_copy -> bvectors[implicant_chosen], i_copy -> variables, &size);
-        for (int j = 0; j < size; j++)
-            fplus_sub2value_sopp(f_copy, indexes[j], min);
-        FREE(indexes);
-        implicants_t *new_implicants = prime_implicants(f_copy);
-        remove_implicant_duplicates(i_copy, new_implicants, f_copy);
-        implicants_soft_destroy(new_implicants);
+    //select the implicant with the lowest max, the values of the points it covers are all reached
+    greedy_t* greedy = greedy_create(f_copy, i_copy);
+    if(greedy == NULL)
+        return sopp_synthesis_failed(sopp, f_copy, primes, implicants, i_copy);
+    cube_t chosen;
+    unsigned min;
+    productp_t product; //reused for each implicant chosen, sopp_add stores a copy
+    product.b_product.variables = i_copy -> variables;
+    while(!budget_over(budget) && greedy_choose(greedy, &chosen, &min)) {
+        product.b_product.cube = chosen;
+        product.coeff = (int) min;
+        sopp_add(sopp, &product);
+
+        fplus_cube_sub_sopp(f_copy, chosen, (int) min);
+        primes_update(primes, chosen);
+        greedy_update_wprimes(greedy, chosen, primes);
     }
 
     //clean up
+    greedy_destroy(greedy);
+    primes_destroy(primes);
     implicants_destroy(implicants);
     implicants_destroy(i_copy);
     fplus_copy_destroy(f_copy);
 
+    if(budget_over(budget) && !sopp_complete(sopp, f)){
+        sopp_destroy(sopp);
+        return NULL;
+    }
     return sopp;
 }
 
@@ -315,19 +706,77 @@ sopp_t* sopp_synthesis(fplus_t* f){
  * @return The minimal sopp form
  */
 sopp_t* sopp_synthesis_experimental(fplus_t* f){
+    arena_t* arena;
+    NULL_CHECK(arena = arena_create(ARENA_BLOCK_SIZE));
+    sopp_t* sopp = sopp_synthesis_experimental_warena(f, arena);
+    arena_destroy(arena);
+    return sopp;
+}
+
+/**
+ * Same as sopp_synthesis_experimental, the temporary memory is allocated in the arena
+ * @param f A fplus function
+ * @param arena The arena, the memory taken is released before returning
+ * @return The minimal sopp form, not in the arena
+ */
+sopp_t* sopp_synthesis_experimental_warena(fplus_t* f, arena_t* arena){
+    return sopp_synthesis_experimental_wbudget_warena(f, NULL, arena);
+}
+
+/**
+ * Same as sopp_synthesis_experimental, the synthesis stops when the budget is over and completes the form found
+ * @param f A fplus function
+ * @param budget The budget, NULL for no limit
+ * @return The sopp form found
+ */
+sopp_t* sopp_synthesis_experimental_wbudget(fplus_t* f, budget_t* budget){
+    arena_t* arena;
+    NULL_CHECK(arena = arena_create(ARENA_BLOCK_SIZE));
+    sopp_t* sopp = sopp_synthesis_experimental_wbudget_warena(f, budget, arena);
+    arena_destroy(arena);
+    return sopp;
+}
+
+/**
+ * Same as sopp_synthesis_experimental, the temporary memory is allocated in the arena. The budget is checked at each
+ * round of the essential implicants, at each implicant chosen and while finding the implicants:
+ * when it is over, the points not yet reached are covered by minterms
+ * @param f A fplus function
+ * @param budget The budget, NULL for no limit
+ * @param arena The arena, the memory taken is released before returning
+ * @return The sopp form found, not in the arena
+ */
+sopp_t* sopp_synthesis_experimental_wbudget_warena(fplus_t* f, budget_t* budget, arena_t* arena){
     sopp_t* sopp; //will store the minimal sopp form
     implicants_t* implicants; //will store prime implicants
     bool go_on;
 
     NULL_CHECK(sopp = sopp_create_wsize(f -> nz_size));
-    NULL_CHECK(implicants = prime_implicants(f));
 
     fplus_t* f_copy = fplus_copy(f);
+    if(f_copy == NULL)
+        return sopp_synthesis_failed(sopp, NULL, NULL, NULL, NULL);
+    primes_t* primes; //kept up to date while the values of f_copy decrease
+    if((primes = primes_create_wbudget(f_copy, budget)) == NULL && budget_over(budget)){
+        //stopped before finding the implicants, all the points are covered by minterms
+        fplus_copy_destroy(f_copy);
+        if(!sopp_complete(sopp, f)){
+            sopp_destroy(sopp);
+            return NULL;
+        }
+        return sopp;
+    }
+    if(primes == NULL)
+        return sopp_synthesis_failed(sopp, f_copy, NULL, NULL, NULL);
+    if((implicants = primes_implicants(primes)) == NULL)
+        return sopp_synthesis_failed(sopp, f_copy, primes, NULL, NULL);
     implicants_t* i_copy = implicants_copy(implicants);
+    if(i_copy == NULL)
+        return sopp_synthesis_failed(sopp, f_copy, primes, implicants, NULL);
 
     essentialsp_t* e;
     do {
-        if((e = essential_implicants(f_copy, i_copy)) == NULL)
+        if(budget_over(budget) || (e = essential_implicants_warena(f_copy, i_copy, arena)) == NULL)
             break;
         if(e->points_size == 0){
             essentials_destroy(e);
@@ -335,8 +784,8 @@ sopp_t* sopp_synthesis_experimental(fplus_t* f){
         for (int i = 0; i < e -> impl_size; i++) {
             int max = 0;
             for (int j = 0; j < e -> points_size; j++) {
-                if (product_of(e -> implicants[i]->b_product, e->points[j])) {
-                    int cur_value = fplus_value_of(f_copy , e->points[j]);
+                if (cube_covers(e -> implicants[i]->b_product.cube, e->points[j])) {
+                    int cur_value = fplus_value_at(f_copy , e->points[j]);
                     if (cur_value > max)
                         max = cur_value;
                 }
@@ -350,89 +799,180 @@ sopp_t* sopp_synthesis_experimental(fplus_t* f){
         //for each implicant chosen update f values
         productp_t** impls = alist_as_array(sopp->arraylist, NULL);
         for(size_t i = 0; i < sopp -> current_length; i++) {
-            int size;
-            int *indexes = binary2decimals(impls[i] ->b_product->product, impls[i] -> b_product -> variables, &size);
-            for (int j = 0; j < size; j++) {
-                fplus_sub2value_sopp(f_copy, indexes[j], impls[i]->coeff);
-            }
-            FREE(indexes);
+            fplus_cube_sub_sopp(f_copy, impls[i] -> b_product.cube, impls[i] -> coeff);
+            primes_update(primes, impls[i] -> b_product.cube);
         }
 
         fplus_update_non_zeros(f_copy);
-        implicants_t *new_implicants = prime_implicants(f_copy);
-        go_on = remove_implicant_duplicates(i_copy, new_implicants, f_copy) && i_copy -> size > 0;
-        implicants_soft_destroy(new_implicants);
+        implicants_t *new_implicants = primes_implicants(primes);
+        if(new_implicants == NULL){
+            essentials_destroy(e);
+            return sopp_synthesis_failed(sopp, f_copy, primes, implicants, i_copy);
+        }
+        go_on = remove_implicant_duplicates_wbudget_warena(i_copy, new_implicants, f_copy, budget, arena) &&
+                i_copy -> size > 0;
+        implicants_destroy(new_implicants);
 
         essentials_destroy(e);
     }while(go_on);
 
-    while(i_copy -> size > 0) {
-        int min = INT_MAX;
-        int implicant_chosen = -1;
-
-        //select the implicant to add
-        for (int i = 0; i < i_copy->size; i++) {
-            int max = 0;
-            int size;
-            int *indexes = binary2decimals(i_copy->bvectors[i], i_copy->variables, &size);
-            for (int j = 0; j < size; j++) {
-                int c_value = fplus_value_at(f_copy, indexes[j]);
-                if (c_value > 0 && c_value > max) {
-                    max = c_value;
-                }
-            }
-            if (max > 0 && max < min) {
-                min = max;
-                implicant_chosen = i;
-            }
-            FREE(indexes);
+    //select the implicant with the lowest max, the values of the points it covers are all reached
+    greedy_t* greedy = greedy_create(f_copy, i_copy);
+    if(greedy == NULL)
+        return sopp_synthesis_failed(sopp, f_copy, primes, implicants, i_copy);
+    cube_t chosen;
+    unsigned min;
+    bool dont_cares_removed = false;
+    productp_t product; //reused for each implicant chosen, sopp_add stores a copy
+    product.b_product.variables = i_copy -> variables;
+    while(!budget_over(budget) && greedy_choose(greedy, &chosen, &min)) {
+        product.b_product.cube = chosen;
+        product.coeff = (int) min;
+        sopp_add(sopp, &product);
+
+        fplus_cube_sub_sopp(f_copy, chosen, (int) min);
+        greedy_update(greedy, chosen);
+
+        //remove implicants covering only don't care points of f, which does not change: only the first time
+        if(!dont_cares_removed){
+            greedy_remove_dont_cares(greedy, f);
+            dont_cares_removed = true;
         }
-        if(implicant_chosen == -1)
-            break;
-        productp_t* p = productp_create(i_copy -> bvectors[implicant_chosen], i_copy -> variables, min);
-
-        //change the dashed into not_present
-        for(int k = 0; k < f -> variables; k++)
-            if(p -> b_product -> product[k] == dash)
-                p -> b_product -> product[k] = not_present;
-        sopp_add(sopp, p);
-        productp_destroy(p);
-
-        int size;
-        int *indexes = binary2decimals(i_copy -> bvectors[implicant_chosen], i_copy -> variables, &size);
-        for (int j = 0; j < size; j++)
-            fplus_sub2value_sopp(f_copy, indexes[j], min);
-        FREE(indexes);
-
-        //remove implicants covering only don't care points
-        int removed = 0;
-        int i = 0;
-        while(i < i_copy->size - removed){
-            indexes = binary2decimals(i_copy->bvectors[i], f->variables, &size);
-            bool removable = true;
-            int j = 0;
-            while(removable && j < size){
-                removable = fplus_value_at(f, indexes[j]) == F_DONT_CARE_VALUE;
-                j++;
-            }
-            if(removable){
-                removed++;
-                FREE(i_copy->bvectors[i]);
-                i_copy->bvectors[i] = i_copy->bvectors[i_copy->size - removed];
-            } else
-                i++;
-            FREE(indexes);
-        }
-
-        //update implicants count
-        i_copy->size -= removed;
     }
 
     //clean up
+    greedy_destroy(greedy);
+    primes_destroy(primes);
     implicants_destroy(implicants);
     implicants_destroy(i_copy);
     fplus_copy_destroy(f_copy);
 
+    if(budget_over(budget) && !sopp_complete(sopp, f)){
+        sopp_destroy(sopp);
+        return NULL;
+    }
+    return sopp;
+}
+
+/**
+ * Frees the memory of a sopp synthesis that ran out of it, the structures not yet created are NULL
+ * @param sopp The form being built, destroyed
+ * @param f_copy The copy of the function
+ * @param primes The primes of the copy
+ * @param implicants The implicants generated
+ * @param i_copy The copy of the implicants
+ * @return NULL
+ */
+sopp_t* sopp_synthesis_failed(sopp_t* sopp, fplus_t* f_copy, primes_t* primes, implicants_t* implicants,
+                              implicants_t* i_copy){
+    fprintf(stderr, "Error: null pointer\n");
+    primes_destroy(primes);
+    if(implicants != NULL)
+        implicants_destroy(implicants);
+    if(i_copy != NULL)
+        implicants_destroy(i_copy);
+    if(f_copy != NULL)
+        fplus_copy_destroy(f_copy);
+    sopp_destroy(sopp);
+    return NULL;
+}
+
+/**
+ * Calculates a sopp form with minimum weight for the given function, with a branch and bound search
+ * over the prime implicants (see exact.h). It takes exponential time, for functions with few variables
+ * @param f A fplus function
+ * @return The minimal sopp form
+ */
+sopp_t* sopp_synthesis_exact(fplus_t* f){
+    return sopp_synthesis_exact_wlimits(f, 1, 0, 0, NULL);
+}
+
+/**
+ * Same as sopp_synthesis_exact, the search is stopped at the given limits
+ * @param f A fplus function
+ * @param threads The number of threads, 0 to use one for each processor online
+ * @param max_nodes Max number of nodes of the search, 0 for no limit
+ * @param max_seconds Max time of the search, 0 for no limit
+ * @param optimal If not NULL, will store true if the form returned is proved minimal
+ * @return The lightest sopp form found
+ */
+sopp_t* sopp_synthesis_exact_wlimits(fplus_t* f, unsigned threads, size_t max_nodes, double max_seconds,
+                                     bool* optimal){
+    exact_t* e;
+    NULL_CHECK(e = exact_create(f, NULL));
+    bool found = exact_search(e, threads, max_nodes, max_seconds, NULL);
+    if(optimal != NULL)
+        *optimal = found;
+    sopp_t* sopp = exact_sopp(e);
+    exact_destroy(e);
+    return sopp;
+}
+
+/**
+ * Runs many synthesis engines at the same time, each on its own thread, and returns the lightest form
+ * found (see portfolio.h)
+ * @param f A fplus function
+ * @param engines The PORTFOLIO_* engines to run, 0 for PORTFOLIO_DEFAULT
+ * @param max_seconds Time after which the lightest form found is returned, 0 for no limit
+ * @return The lightest sopp form found
+ */
+sopp_t* sopp_synthesis_portfolio(fplus_t* f, unsigned engines, double max_seconds){
+    return portfolio_synthesis(f, engines, false, max_seconds).form;
+}
+
+/**
+ * Calculates a sopp form for the given function without finding its prime implicants, to be used
+ * with functions having too many variables for the other procedures.
+ * The points are covered in layers: given the distinct values v1 < v2 < ... of f, the layer i
+ * covers the points with value >= vi with products of coefficient vi - vi-1, found with an
+ * Espresso-like heuristic (see espresso.h). The points with value 0 are never covered
+ * @param f A fplus function
+ * @return A (not always minimal) sopp form
+ */
+sopp_t* sopp_synthesis_heuristic(fplus_t* f){
+    return sopp_synthesis_heuristic_wbudget(f, NULL);
+}
+
+/**
+ * Same as sopp_synthesis_heuristic, the budget is checked at each layer and by espresso_minimize_wbudget:
+ * when it is over, the points not yet reached are covered by minterms
+ * @param f A fplus function
+ * @param budget The budget, NULL for no limit
+ * @return The sopp form found
+ */
+sopp_t* sopp_synthesis_heuristic_wbudget(fplus_t* f, budget_t* budget){
+    espresso_t* e;
+    productp_t* products; //products of all the layers
+    size_t size = 0, max_size = INIT_SIZE;
+
+    NULL_CHECK(e = espresso_create(f));
+    MALLOC(products, sizeof(productp_t) * max_size, espresso_destroy(e));
+    int previous = 0, lowest;
+    while(!budget_over(budget) && (lowest = espresso_minimize_wbudget(e, previous, budget)) > 0){
+        size_t cover_size;
+        cube_t* cover = espresso_cover(e, &cover_size);
+        while(size + cover_size > max_size)
+            max_size *= 2;
+        REALLOC(products, sizeof(productp_t) * max_size, espresso_destroy(e); return NULL);
+        for(size_t i = 0; i < cover_size; i++){
+            products[size].b_product.cube = cover[i];
+            products[size].b_product.variables = f -> variables;
+            products[size++].coeff = lowest - previous;
+        }
+        previous = lowest;
+    }
+
+    //products of different layers may be the same, their coefficients are summed
+    sopp_t* sopp = sopp_create_wsize(size);
+    for(size_t i = 0; sopp != NULL && i < size; i++)
+        sopp_add(sopp, products + i);
+
+    FREE(products);
+    espresso_destroy(e);
+    if(sopp != NULL && budget_over(budget) && !sopp_complete(sopp, f)){
+        sopp_destroy(sopp);
+        return NULL;
+    }
     return sopp;
 }
 
@@ -460,37 +1000,23 @@ bool sopp_not_empty(sopp_t* sopp){
 
 /**
  * Checks if dsopp_t is a correct disjoint sop plus form of the function fun
- * time: exponential in number of variables
+ * time: linear in the points of the function plus the points covered by the products
+ * (only the latter if sparse)
  * @return true it is valid
  */
 bool dsopp_form_of(dsopp_t* sopp, fplus_t* fun){
-    unsigned length = fun -> variables;
-    bool value[length];
-    memset(value, 0, sizeof(bool) * length);
-    bool result = true;
-    dsopp_binaries(value, length, sopp, fun, &result);
-    return result;
+    return dsopp_form_of_wthreads(sopp, fun, 1);
 }
 
-/*
- * rec-fun called by dsopp_form_of
- *
- * generates all the possible combinations of the variables
- * and checks if the values of the fun matches the values
- * of the disjoint sop plus form
+/**
+ * Same as dsopp_form_of, a dense function is checked by more threads
+ * @param threads The number of threads, 0 to use one for each online processor
+ * @return true it is valid
  */
-void dsopp_binaries(bool *value, unsigned i, dsopp_t* sop, fplus_t* fun, bool* result) {
-    if(*result) {
-        if (i == 0) {
-            int fvalue = fplus_value_of(fun, value);
-            *result = *result && sopp_value_of(sop, value) == fvalue;
-        } else {
-            value[i - 1] = 0;
-            dsopp_binaries(value, i - 1, sop, fun, result);
-            value[i - 1] = 1;
-            dsopp_binaries(value, i - 1, sop, fun, result);
-        }
-    }
+bool dsopp_form_of_wthreads(dsopp_t* sopp, fplus_t* fun, unsigned threads){
+    if(fun -> sparse != NULL)
+        return sopp_sparse_form_of(sopp, fun, true);
+    return sopp_dense_form_of(sopp, fun, true, threads);
 }
 
 /**
@@ -503,12 +1029,7 @@ void dsopp_print(sopp_t* d){
     printf("Dsopp form is: \n");
     for(size_t i = 0; i < size; i++){
         printf("Product has coeff: %d and is: ", (array[i]) -> coeff);
-        for(int j = 0; j < array[0] -> b_product -> variables; j++){
-            if(array[i] -> b_product -> product[j] > 1)
-                printf("- ");
-            else
-                printf("%d ", array[i] -> b_product -> product[j]);
-        }
+        cube_print(array[i] -> b_product.cube, array[i] -> b_product.variables, ' ');
         printf("\n");
     }
 }
@@ -520,35 +1041,123 @@ void dsopp_print(sopp_t* d){
  * @return The minimal dsopp form
  */
 dsopp_t* dsopp_synthesis(fplus_t* f){
+    arena_t* arena;
+    NULL_CHECK(arena = arena_create(ARENA_BLOCK_SIZE));
+    dsopp_t* dsopp = dsopp_synthesis_warena(f, arena);
+    arena_destroy(arena);
+    return dsopp;
+}
+
+/**
+ * Same as dsopp_synthesis, the temporary memory is allocated in the arena
+ * @param f A fplus function
+ * @param arena The arena, the memory taken is released before returning
+ * @return The dsopp form, not in the arena
+ */
+dsopp_t* dsopp_synthesis_warena(fplus_t* f, arena_t* arena){
+    return dsopp_synthesis_wbudget_warena(f, NULL, arena);
+}
+
+/**
+ * Same as dsopp_synthesis, the synthesis stops when the budget is over and completes the form found
+ * @param f A fplus function
+ * @param budget The budget, NULL for no limit
+ * @return The dsopp form found
+ */
+dsopp_t* dsopp_synthesis_wbudget(fplus_t* f, budget_t* budget){
+    arena_t* arena;
+    NULL_CHECK(arena = arena_create(ARENA_BLOCK_SIZE));
+    dsopp_t* dsopp = dsopp_synthesis_wbudget_warena(f, budget, arena);
+    arena_destroy(arena);
+    return dsopp;
+}
+
+/**
+ * Same as dsopp_synthesis, the temporary memory is allocated in the arena. The budget is checked at each
+ * round and at each product taken, as well as by the sopp syntheses: when it is over, the points whose
+ * output is not yet reached are covered by minterms
+ * @param f A fplus function
+ * @param budget The budget, NULL for no limit
+ * @param arena The arena, the memory taken is released before returning
+ * @return The dsopp form found, not in the arena
+ */
+dsopp_t* dsopp_synthesis_wbudget_warena(fplus_t* f, budget_t* budget, arena_t* arena){
+    sopp_t* sopp;
+    NULL_CHECK(sopp = sopp_synthesis_wbudget_warena(f, budget, arena));
+    dsopp_t* dsopp = dsopp_rounds(f, sopp, sopp_synthesis_wbudget_warena, budget, arena);
+    sopp_destroy(sopp);
+    return dsopp;
+}
+
+/**
+ * Same as dsopp_synthesis, the first round takes the products of the given sopp form instead of
+ * synthesizing it, the following ones use sopp_synthesis. Most of the time of dsopp_synthesis is
+ * spent in the first round, so this saves it when the sopp form of the function is already known
+ * @param f A fplus function
+ * @param sopp A sopp form of f, not changed
+ * @return The dsopp form
+ */
+dsopp_t* dsopp_synthesis_wsopp(fplus_t* f, sopp_t* sopp){
+    arena_t* arena;
+    NULL_CHECK(arena = arena_create(ARENA_BLOCK_SIZE));
+    dsopp_t* dsopp = dsopp_rounds(f, sopp, sopp_synthesis_wbudget_warena, NULL, arena);
+    arena_destroy(arena);
+    return dsopp;
+}
+
+/**
+ * Builds a dsopp form in rounds: the products of a sopp form of the values not yet reached are taken
+ * by pqueue_max_product, each one with the highest coefficient keeping the form below the function,
+ * then the sopp form of the values left is synthesized for the next round
+ * @param f A fplus function
+ * @param first The sopp form of the first round, not changed
+ * @param next The synthesis of the sopp forms of the following rounds
+ * @param budget The budget, checked at each round and at each product taken, NULL for no limit.
+ *      When it is over, the points whose output is not yet reached are covered by minterms
+ * @param arena The arena, the memory taken is released before returning
+ * @return The dsopp form, not in the arena
+ */
+dsopp_t* dsopp_rounds(fplus_t* f, sopp_t* first, round_synthesis_t next, budget_t* budget, arena_t* arena){
+    arena_mark_t mark = arena_mark(arena);
     dsopp_t* dsopp = sopp_create_wsize(f->nz_size);
     NULL_CHECK(dsopp);
-    sopp_t* sopp = sopp_synthesis(f);
-    NULL_CHECK(sopp);
-    llist_t* product_list = llist_create(); //array of int pointer (not array of arrays)
-    NULL_CHECK(product_list);
+    pqueue_t* product_queue = pqueue_create();
+    NULL_CHECK(product_queue);
     fplus_t* f_copy = fplus_copy(f);
 
-    while(f_copy->nz_size > 0 && sopp_not_empty(sopp)) {
+    sopp_t* sopp = first;
+    while(sopp != NULL && f_copy->nz_size > 0 && sopp_not_empty(sopp) && !budget_over(budget)) {
         productp_t **products = alist_as_array(sopp->arraylist, NULL);
         for (int i = 0; i < sopp->current_length; i++) {
-            llist_add(product_list, products[i]);
+            pqueue_add(product_queue, products[i], f_copy);
         }
         int k;
         productp_t* p;
-        while(llist_length(product_list) > 0 && (p = llist_max_product(product_list, &k, f_copy)) != NULL){
+        while(pqueue_length(product_queue) > 0 && !budget_over(budget) &&
+                (p = pqueue_max_product(product_queue, &k, f_copy)) != NULL){
             int old_coeff = p->coeff;
             p->coeff = k;
             sopp_add(dsopp, p);
             p->coeff = old_coeff;
         }
+        //the products left cover only don't care points and would outlive their sopp
+        pqueue_clear(product_queue);
         fplus_update_non_zeros(f_copy);
-        sopp_destroy(sopp);
-        sopp = sopp_synthesis(f_copy);
+        if(sopp != first)
+            sopp_destroy(sopp);
+        sopp = next(f_copy, budget, arena);
     }
+    bool failed = sopp == NULL;
 
-    llist_destroy(product_list);
+    pqueue_destroy(product_queue);
     fplus_copy_destroy(f_copy);
-    sopp_destroy(sopp);
+    if(sopp != first)
+        sopp_destroy(sopp);
+    arena_rewind(arena, mark);
+    if(failed || (budget_over(budget) && !sopp_complete(dsopp, f))){
+        sopp_destroy(dsopp);
+        return NULL;
+    }
     return dsopp;
 }
 
@@ -558,59 +1167,220 @@ dsopp_t* dsopp_synthesis(fplus_t* f){
  * @return The minimal dsopp form
  */
 dsopp_t* dsopp_synthesis_wexperimental(fplus_t* f){
-    dsopp_t* dsopp = sopp_create_wsize(f->nz_size);
-    NULL_CHECK(dsopp);
-    sopp_t* sopp = sopp_synthesis_experimental(f);
-    NULL_CHECK(sopp);
-    llist_t* product_list = llist_create(); //array of int pointer (not array of arrays)
-    NULL_CHECK(product_list);
-    fplus_t* f_copy = fplus_copy(f);
+    arena_t* arena;
+    NULL_CHECK(arena = arena_create(ARENA_BLOCK_SIZE));
+    dsopp_t* dsopp = dsopp_synthesis_wexperimental_warena(f, arena);
+    arena_destroy(arena);
+    return dsopp;
+}
 
-    while(f_copy->nz_size > 0 && sopp_not_empty(sopp)) {
-        productp_t **products = alist_as_array(sopp->arraylist, NULL);
-        for (int i = 0; i < sopp->current_length; i++) {
-            llist_add(product_list, products[i]);
-        }
-        int k;
-        productp_t* p;
-        while(llist_length(product_list) > 0 && (p = llist_max_product(product_list, &k, f_copy)) != NULL){
-            int old_coeff = p->coeff;
-            p->coeff = k;
-            sopp_add(dsopp, p);
-            p->coeff = old_coeff;
-        }
-        fplus_update_non_zeros(f_copy);
-        sopp_destroy(sopp);
-        sopp = sopp_synthesis_experimental(f_copy);
-    }
+/**
+ * Same as dsopp_synthesis_wexperimental, the temporary memory is allocated in the arena
+ * @param f A fplus function
+ * @param arena The arena, the memory taken is released before returning
+ * @return The dsopp form, not in the arena
+ */
+dsopp_t* dsopp_synthesis_wexperimental_warena(fplus_t* f, arena_t* arena){
+    return dsopp_synthesis_wexperimental_wbudget_warena(f, NULL, arena);
+}
 
-    llist_destroy(product_list);
-    fplus_copy_destroy(f_copy);
+/**
+ * Same as dsopp_synthesis_wexperimental, the synthesis stops when the budget is over and completes the form found
+ * @param f A fplus function
+ * @param budget The budget, NULL for no limit
+ * @return The dsopp form found
+ */
+dsopp_t* dsopp_synthesis_wexperimental_wbudget(fplus_t* f, budget_t* budget){
+    arena_t* arena;
+    NULL_CHECK(arena = arena_create(ARENA_BLOCK_SIZE));
+    dsopp_t* dsopp = dsopp_synthesis_wexperimental_wbudget_warena(f, budget, arena);
+    arena_destroy(arena);
+    return dsopp;
+}
+
+/**
+ * Same as dsopp_synthesis_wexperimental, the temporary memory is allocated in the arena. The budget is checked at each
+ * round and at each product taken, as well as by the sopp syntheses: when it is over, the points whose
+ * output is not yet reached are covered by minterms
+ * @param f A fplus function
+ * @param budget The budget, NULL for no limit
+ * @param arena The arena, the memory taken is released before returning
+ * @return The dsopp form found, not in the arena
+ */
+dsopp_t* dsopp_synthesis_wexperimental_wbudget_warena(fplus_t* f, budget_t* budget, arena_t* arena){
+    sopp_t* sopp;
+    NULL_CHECK(sopp = sopp_synthesis_experimental_wbudget_warena(f, budget, arena));
+    dsopp_t* dsopp = dsopp_rounds(f, sopp, sopp_synthesis_experimental_wbudget_warena, budget, arena);
+    sopp_destroy(sopp);
+    return dsopp;
+}
+
+
+/**
+ * Similar to dsopp_synthesis but it uses the heuristic sopp synthesis instead of regular
+ * @param f A fplus function
+ * @return A dsopp form
+ */
+dsopp_t* dsopp_synthesis_wheuristic(fplus_t* f){
+    return dsopp_synthesis_wheuristic_wbudget(f, NULL);
+}
+
+/**
+ * Same as dsopp_synthesis_wheuristic, the synthesis stops when the budget is over and completes the form found
+ * @param f A fplus function
+ * @param budget The budget, NULL for no limit
+ * @return The dsopp form found
+ */
+dsopp_t* dsopp_synthesis_wheuristic_wbudget(fplus_t* f, budget_t* budget){
+    sopp_t* sopp;
+    arena_t* arena;
+    NULL_CHECK(sopp = sopp_synthesis_heuristic_wbudget(f, budget));
+    NULL_CHECK(arena = arena_create(ARENA_BLOCK_SIZE));
+    dsopp_t* dsopp = dsopp_rounds(f, sopp, dsopp_heuristic_round, budget, arena);
+    arena_destroy(arena);
     sopp_destroy(sopp);
     return dsopp;
 }
 
-
 /**
- * Creates a boolean plus function with the given parameters
- * @param values An array containing all the outputs of the function (values[i] = f(binary(i))
- * @param non_zeros An array with all the index (in binary) of the non-zeros values of the function
+ * A round of dsopp_synthesis_wheuristic: sopp_synthesis_heuristic_wbudget, which takes no arena
+ * @param f A fplus function
+ * @param budget The budget, NULL for no limit
+ * @param arena Not used
+ * @return A sopp form
+ */
+sopp_t* dsopp_heuristic_round(fplus_t* f, budget_t* budget, arena_t* arena){
+    (void) arena;
+    return sopp_synthesis_heuristic_wbudget(f, budget);
+}
+
+/**
+ * Same as sopp_synthesis_portfolio for dsopp forms, PORTFOLIO_EXACT is ignored
+ * @param f A fplus function
+ * @param engines The PORTFOLIO_* engines to run, 0 for PORTFOLIO_DEFAULT
+ * @param max_seconds Time after which the lightest form found is returned, 0 for no limit
+ * @return The lightest dsopp form found
+ */
+dsopp_t* dsopp_synthesis_portfolio(fplus_t* f, unsigned engines, double max_seconds){
+    return portfolio_synthesis(f, engines, true, max_seconds).form;
+}
+
+/**
+ * Creates a boolean plus function with the given parameters
+ * @param values An array containing all the outputs of the function (values[i] = f(binary(i)),
+ *      it is moved to the compact representation and freed
+ * @param non_zeros An array with all the index (as decimal) of the non-zeros values of the function
+ * @param variables Number of variables taken by the function
+ * @param size size of the non_zeros array
+ * @return A pointer to the function, NULL if variables is not below FPLUS_MAX_VARIABLES
+ */
+fplus_t* fplus_create(int* values, point_t* non_zeros, int variables, int size){
+    if(variables < 0 || variables >= FPLUS_MAX_VARIABLES)
+        return NULL;
+    fplus_t* function = malloc(sizeof(fplus_t));
+    NULL_CHECK(function);
+    size_t f_size = (size_t) 1 << variables;
+    int max_value = 0;
+    for(size_t i = 0; i < f_size; i++)
+        if(values[i] > max_value)
+            max_value = values[i];
+    NULL_CHECK(function -> values = fvalues_create(f_size, max_value));
+    for(size_t i = 0; i < f_size; i++)
+        fvalues_set(function -> values, i, values[i]);
+    FREE(values);
+    function -> variables = variables;
+    function -> non_zeros = non_zeros;
+    function -> nz_size = size;
+    function -> sparse = NULL;
+    return function;
+}
+
+/**
+ * Creates a sparse boolean plus function, only the given points are stored and all the others have value 0.
+ * The memory used depends on the number of points and not on the number of variables (up to CWORD_BITS)
+ * @param points The points as decimals, for duplicates only the first value is kept
+ * @param values values[i] is the output of points[i], the arrays are copied
+ * @param size The size of both arrays
+ * @param variables Number of variables taken by the function
+ * @return A pointer to the function, NULL if variables is above FPLUS_MAX_VARIABLES
+ */
+fplus_t* fplus_create_sparse(const point_t* points, const int* values, size_t size, unsigned variables){
+    if(variables > FPLUS_MAX_VARIABLES)
+        return NULL;
+    fplus_t* function;
+    MALLOC(function, sizeof(fplus_t), ;);
+    function -> variables = variables;
+    int max_value = 0;
+    for(size_t i = 0; i < size; i++)
+        if(values[i] > max_value)
+            max_value = values[i];
+    NULL_CHECK(function -> sparse = cubeset_create(size));
+    NULL_CHECK(function -> values = fvalues_create(function -> sparse -> max_length, max_value));
+    MALLOC(function -> non_zeros, sizeof(point_t) * (size > 0 ? size : 1),
+           fvalues_destroy(function -> values); cubeset_destroy(function -> sparse); FREE(function));
+
+    function -> nz_size = 0;
+    for(size_t i = 0; i < size; i++){
+        if(!cubeset_add(function -> sparse, cube_of_point(points[i], variables)))
+            continue; //duplicated point, the first value is kept
+        fvalues_set(function -> values, cubeset_length(function -> sparse) - 1, values[i]);
+        if(values[i] != 0)
+            function -> non_zeros[function -> nz_size++] = cube_of_point(points[i], variables).value;
+    }
+    return function;
+}
+
+/**
+ * Creates a sparse boolean plus function (see fplus_create_sparse) with random outputs.
+ * Each point stored has a random output between 1 and max_value
+ * @param variables Number of variables taken by the function
+ * @param max_value Max value for the output of the function
+ * @param size Number of non zero points, at most 2^variables
+ * @return A pointer to the function
+ */
+fplus_t* fplus_create_random_sparse(unsigned variables, int max_value, size_t size){
+    return fplus_create_random_sparse_wseed(variables, max_value, size, prng_clock_seed());
+}
+
+/**
+ * Same as fplus_create_random_sparse, the same seed always gives the same function
  * @param variables Number of variables taken by the function
- * @param size size of the non_zeros array
- * @return A pointer to the function
+ * @param max_value Max value for the output of the function
+ * @param size Number of non zero points, at most 2^variables
+ * @param seed The seed of the outputs
+ * @return A pointer to the function, NULL if variables is above FPLUS_MAX_VARIABLES
  */
-fplus_t* fplus_create(int* values, bvector* non_zeros, int variables, int size){
-    fplus_t* function = malloc(sizeof(fplus_t));
-    NULL_CHECK(function);
-    function -> values = values;
-    function -> variables = variables;
-    function -> non_zeros = non_zeros;
-    function -> nz_size = size;
+fplus_t* fplus_create_random_sparse_wseed(unsigned variables, int max_value, size_t size, uint64_t seed){
+    if(variables > FPLUS_MAX_VARIABLES)
+        return NULL;
+    prng_t generator;
+    prng_seed(&generator, seed);
+    cubeset_t* points;
+    int* values;
+    NULL_CHECK(points = cubeset_create(size));
+    MALLOC(values, sizeof(int) * (size > 0 ? size : 1), cubeset_destroy(points));
+
+    while(cubeset_length(points) < size){
+        point_t point = prng_next(&generator);
+        if(cubeset_add(points, cube_of_point(point, variables)))
+            values[cubeset_length(points) - 1] = (int) prng_below(&generator, max_value) + 1;
+    }
+
+    point_t* decimals;
+    MALLOC(decimals, sizeof(point_t) * (size > 0 ? size : 1), FREE(values); cubeset_destroy(points));
+    cube_t* cubes = cubeset_as_array(points, NULL);
+    for(size_t i = 0; i < size; i++)
+        decimals[i] = cubes[i].value;
+    fplus_t* function = fplus_create_sparse(decimals, values, size, variables);
+
+    FREE(decimals);
+    FREE(values);
+    cubeset_destroy(points);
     return function;
 }
 
 /**
- * Creates a boolean plus function with random outputs.
+ * Creates a boolean plus function with random outputs, filled by the calling thread only.
  * Each non zero value has a random output between 1 and max_value
  * @param variables Number of variables taken by the function
  * @param max_value Max value for the output of the function
@@ -618,73 +1388,160 @@ fplus_t* fplus_create(int* values, bvector* non_zeros, int variables, int size){
  * @return A pointer to the function
  */
 fplus_t* fplus_create_random(unsigned variables, int max_value, unsigned non_zero_chance){
-    struct timespec spec;
-    clock_gettime(CLOCK_REALTIME, &spec);
-    srandom(spec.tv_nsec);
-    fplus_t* function;
-    unsigned long f_size = 1;
-    f_size = f_size << variables;
-    int non_zeros_index = 0;
+    return fplus_random_dense(variables, max_value, non_zero_chance, 0, prng_clock_seed(), 1);
+}
 
-    MALLOC(function, sizeof(fplus_t), ;);
-    MALLOC(function -> values, sizeof(int) * f_size, FREE(function));
-    MALLOC(function -> non_zeros, sizeof(bvector) * f_size, FREE(function -> values); FREE(function));
-
-    for(size_t i = 0; i < f_size; i++){
-        bool is_non_zero = random() % 100;
-        if(is_non_zero < non_zero_chance) {
-            function -> values[i] = (int) ((random()) % max_value) + 1;
-            function -> non_zeros[non_zeros_index++] = decimal2binary(i, variables); //end of array
-        }else
-            function -> values[i] = 0;
-    }
-    function -> variables = variables;
-    function -> nz_size = non_zeros_index; //end of array
-    REALLOC(function -> non_zeros, sizeof(bvector) * non_zeros_index, ;);
-    return function;
+/**
+ * Same as fplus_create_random, the same seed always gives the same function (whatever the number of threads)
+ * @param variables Number of variables taken by the function
+ * @param max_value Max value for the output of the function
+ * @param non_zero_chance The probability (as percentage) of having a non zero value as output
+ * @param seed The seed of the outputs
+ * @param threads The number of threads filling the function, 0 to use one for each online processor
+ * @return A pointer to the function
+ */
+fplus_t* fplus_create_random_wseed(unsigned variables, int max_value, unsigned non_zero_chance, uint64_t seed,
+                                   unsigned threads){
+    return fplus_random_dense(variables, max_value, non_zero_chance, 0, seed, threads);
 }
 
 /**
- * Creates a boolean plus function with random outputs, some may be don't care values (50% chance).
- * Each non zero value has a random output between 1 and max_value
+ * Creates a boolean plus function with random outputs, some may be don't care values (50% chance),
+ * filled by the calling thread only. Each non zero value has a random output between 1 and max_value
  * @param variables Number of variables taken by the function
  * @param max_value Max value for the output of the function
  * @param non_zero_chance The probability (as percentage) of having a non zero value as output
  * @return A pointer to the function
  */
 fplus_t* fplus_create_random_wundefined(unsigned variables, int max_value, unsigned non_zero_chance){
-    struct timespec spec;
-    clock_gettime(CLOCK_REALTIME, &spec);
-    srandom(spec.tv_nsec);
+    return fplus_random_dense(variables, max_value, non_zero_chance, PROBABILITY_UNDEFINED, prng_clock_seed(), 1);
+}
+
+/**
+ * Same as fplus_create_random_wundefined, the same seed always gives the same function
+ * (whatever the number of threads)
+ * @param variables Number of variables taken by the function
+ * @param max_value Max value for the output of the function
+ * @param non_zero_chance The probability (as percentage) of having a non zero value as output
+ * @param seed The seed of the outputs
+ * @param threads The number of threads filling the function, 0 to use one for each online processor
+ * @return A pointer to the function
+ */
+fplus_t* fplus_create_random_wundefined_wseed(unsigned variables, int max_value, unsigned non_zero_chance,
+                                              uint64_t seed, unsigned threads){
+    return fplus_random_dense(variables, max_value, non_zero_chance, PROBABILITY_UNDEFINED, seed, threads);
+}
+
+/**
+ * Creates a dense function with random outputs. The domain is split in chunks of 2^RANDOM_CHUNK_VARIABLES
+ * points filled by the workers, each one with its own stream of the seed, so the function does not depend
+ * on the number of threads. Each chunk stores its non zero points from the position of its first point,
+ * then they are moved next to the ones of the previous chunks
+ * @param variables Number of variables taken by the function
+ * @param max_value Max value for the output of the function
+ * @param non_zero_chance The probability (as percentage) of having a non zero value as output
+ * @param undefined_chance The probability (as percentage) of having a don't care value as output
+ * @param seed The seed of the outputs
+ * @param threads The number of threads filling the function, 0 to use one for each online processor
+ * @return A pointer to the function, NULL if variables is not below FPLUS_MAX_VARIABLES
+ */
+fplus_t* fplus_random_dense(unsigned variables, int max_value, unsigned non_zero_chance, unsigned undefined_chance,
+                           uint64_t seed, unsigned threads){
+    if(variables >= FPLUS_MAX_VARIABLES)
+        return NULL;
+    if(threads == 0) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = online > 0 ? (unsigned) online : 1;
+    }
     fplus_t* function;
-    unsigned long f_size = 1;
-    f_size = f_size << variables;
-    int non_zeros_index = 0;
+    size_t f_size = (size_t) 1 << variables;
 
     MALLOC(function, sizeof(fplus_t), ;);
-    MALLOC(function -> values, sizeof(int) * f_size, FREE(function));
-    MALLOC(function -> non_zeros, sizeof(bvector) * f_size, FREE(function -> values); FREE(function));
-
-    for(size_t i = 0; i < f_size; i++){
-        bool is_undefined = random() % 100;
-        if(is_undefined < PROBABILITY_UNDEFINED) {
-            function->values[i] = F_DONT_CARE_VALUE;
-            function->non_zeros[non_zeros_index++] = decimal2binary(i, variables);
-        } else {
-            bool is_non_zero = random() % 100;
-            if (is_non_zero < non_zero_chance) {
-                function->values[i] = (int) ((random()) % max_value) + 1;
-                function->non_zeros[non_zeros_index++] = decimal2binary(i, variables);
-            } else
-                function->values[i] = 0;
-        }
-    }
+    //wide enough for max_value, so that the workers never widen the values
+    NULL_CHECK(function -> values = fvalues_create(f_size, max_value));
+    MALLOC(function -> non_zeros, sizeof(point_t) * f_size, fvalues_destroy(function -> values); FREE(function));
     function -> variables = variables;
-    function -> nz_size = non_zeros_index; //end of array
-    REALLOC(function -> non_zeros, sizeof(bvector) * non_zeros_index, ;);
+    function -> sparse = NULL;
+
+    random_work_t work;
+    work.f = function;
+    work.max_value = max_value;
+    work.non_zero_chance = non_zero_chance;
+    work.undefined_chance = undefined_chance;
+    work.seed = seed;
+    work.shift = variables < RANDOM_CHUNK_VARIABLES ? variables : RANDOM_CHUNK_VARIABLES;
+    work.n_chunks = (size_t) 1 << (variables - work.shift);
+    work.next_chunk = 0;
+    MALLOC(work.chunk_sizes, sizeof(size_t) * work.n_chunks, fplus_destroy(function));
+    unsigned n_workers = threads < work.n_chunks ? threads : (unsigned) work.n_chunks;
+    pthread_t* workers;
+    MALLOC(workers, sizeof(pthread_t) * n_workers, FREE(work.chunk_sizes); fplus_destroy(function));
+    pthread_mutex_init(&work.lock, NULL);
+
+    unsigned started = 0;
+    while (started + 1 < n_workers && pthread_create(workers + started, NULL, random_worker, &work) == 0)
+        started++;
+    random_worker(&work);
+    for (unsigned t = 0; t < started; t++)
+        pthread_join(workers[t], NULL);
+    pthread_mutex_destroy(&work.lock);
+    FREE(workers);
+
+    size_t non_zeros_index = 0;
+    for(size_t c = 0; c < work.n_chunks; c++){
+        memmove(function -> non_zeros + non_zeros_index, function -> non_zeros + (c << work.shift),
+                sizeof(point_t) * work.chunk_sizes[c]);
+        non_zeros_index += work.chunk_sizes[c];
+    }
+    FREE(work.chunk_sizes);
+    function -> nz_size = non_zeros_index;
+    REALLOC(function -> non_zeros, sizeof(point_t) * non_zeros_index, ;);
     return function;
 }
 
+/**
+ * Fills chunks until there are none left
+ * @param arg The shared random_work_t
+ */
+void* random_worker(void* arg){
+    random_work_t* work = arg;
+    while (true) {
+        pthread_mutex_lock(&work -> lock);
+        size_t chunk = work -> next_chunk++;
+        pthread_mutex_unlock(&work -> lock);
+        if (chunk >= work -> n_chunks)
+            break;
+        random_fill_chunk(work, chunk);
+    }
+    return NULL;
+}
+
+/**
+ * Sets random outputs to the points of the chunk, with the stream of the seed of the chunk.
+ * The chunks start and end on word boundaries of the values, so no two workers write the same word
+ * @param work The shared state
+ * @param chunk The chunk to fill
+ */
+void random_fill_chunk(random_work_t* work, size_t chunk){
+    prng_t generator;
+    prng_seed_wstream(&generator, work -> seed, chunk);
+    fvalues_t* values = work -> f -> values;
+    point_t* non_zeros = work -> f -> non_zeros;
+    size_t start = chunk << work -> shift;
+    size_t end = start + ((size_t) 1 << work -> shift);
+    size_t count = 0;
+    for(size_t i = start; i < end; i++){
+        if(work -> undefined_chance > 0 && prng_below(&generator, 100) < work -> undefined_chance) {
+            fvalues_set(values, i, F_DONT_CARE_VALUE);
+            non_zeros[start + count++] = i;
+        } else if(prng_below(&generator, 100) < work -> non_zero_chance) {
+            fvalues_set(values, i, (int) prng_below(&generator, work -> max_value) + 1);
+            non_zeros[start + count++] = i;
+        }
+    }
+    work -> chunk_sizes[chunk] = count;
+}
+
 /**
  * returns the output of the function with the given input (binary)
  * @param f A pointer to the boolean plus function
@@ -692,10 +1549,10 @@ fplus_t* fplus_create_random_wundefined(unsigned variables, int max_value, unsig
  * @return The output of the function
  */
 int fplus_value_of(fplus_t* f, bool input[]){
-    int index = binary2decimal(input, f -> variables);
-    if(index == -1)
+    cube_t c = cube_from_bvector(input, f -> variables);
+    if(c.care != CUBE_MASK(f -> variables))
         return 0;
-    return f -> values[index];
+    return fplus_value_at(f, c.value);
 }
 
 /**
@@ -704,8 +1561,70 @@ int fplus_value_of(fplus_t* f, bool input[]){
  * @param index The input, given as decimal
  * @return The output of the function
  */
-int fplus_value_at(fplus_t* f, int index){
-    return f -> values[index];
+int fplus_value_at(fplus_t* f, point_t index){
+    long i = fplus_index_of(f, index);
+    return i < 0 ? 0 : fplus_value_in(f, i);
+}
+
+/**
+ * @param f The function
+ * @param position A position of the values, lower than fplus_size
+ * @return The value stored in the position, F_DONT_CARE_VALUE for a don't care
+ */
+int fplus_value_in(fplus_t* f, size_t position){
+    if(fvalues_is_dont_care(f -> values, position))
+        return F_DONT_CARE_VALUE;
+    return (int) fvalues_get(f -> values, position);
+}
+
+/**
+ * @return The number of values stored by the function: 2^variables or,
+ *      if the function is sparse, the number of points stored
+ */
+size_t fplus_size(fplus_t* f){
+    if(f -> sparse == NULL)
+        return (size_t) 1 << f -> variables;
+    return cubeset_length(f -> sparse);
+}
+
+/**
+ * @param f The function
+ * @param index A point given as decimal
+ * @return The position of the value of the point in f -> values, -1 if not stored (its value is 0)
+ */
+long fplus_index_of(fplus_t* f, point_t index){
+    if(f -> sparse == NULL)
+        return (long) index;
+    return cubeset_index_of(f -> sparse, cube_of_point(index, f -> variables));
+}
+
+/**
+ * @param f The function
+ * @param i A position of f -> values, lower than fplus_size
+ * @return The point whose value is stored in the given position
+ */
+point_t fplus_point_at(fplus_t* f, size_t i){
+    if(f -> sparse == NULL)
+        return i;
+    return f -> sparse -> cubes[i].value;
+}
+
+/**
+ * Returns the position where the value of the point is stored.
+ * If the function is sparse and the point is not stored, it is added with value 0
+ * @param f The function
+ * @param index The point given as decimal
+ * @return The position of the value or -1 in case of error
+ */
+long fplus_insert(fplus_t* f, point_t index){
+    if(f -> sparse == NULL)
+        return (long) index;
+    cube_t c = cube_of_point(index, f -> variables);
+    if(cubeset_add(f -> sparse, c) && f -> sparse -> max_length != f -> values -> size){
+        if(!fvalues_resize(f -> values, f -> sparse -> max_length))
+            return -1;
+    }
+    return cubeset_index_of(f -> sparse, c);
 }
 
 /**
@@ -715,12 +1634,17 @@ int fplus_value_at(fplus_t* f, int index){
  * @param index The input to which change the output
  * @param increment The increment (may be negative)
  */
-void fplus_add2value(fplus_t* f, int index, int increment){
-    if(f -> values[index] <= -increment) {
-        f -> values[index] = F_DONT_CARE_VALUE;
+void fplus_add2value(fplus_t* f, point_t index, int increment){
+    long position = fplus_insert(f, index);
+    if(position < 0)
+        return;
+    int value = fplus_value_in(f, position);
+    if(value <= -increment) {
+        value = F_DONT_CARE_VALUE;
     } else {
-        f->values[index] += increment;
+        value += increment;
     }
+    fvalues_set(f -> values, position, value);
 }
 
 /**
@@ -731,11 +1655,15 @@ void fplus_add2value(fplus_t* f, int index, int increment){
  * @param index The input given as a decimal
  * @param decrement The amount to decrement
  */
-void fplus_sub2value_sopp(fplus_t* f, int index, int decrement){
-    f -> values[index] -= decrement;
-    if(f -> values[index] <= 0) {
-        f->values[index] = F_DONT_CARE_VALUE;
+void fplus_sub2value_sopp(fplus_t* f, point_t index, int decrement){
+    long position = fplus_insert(f, index);
+    if(position < 0)
+        return;
+    int value = fplus_value_in(f, position) - decrement;
+    if(value <= 0) {
+        value = F_DONT_CARE_VALUE;
     }
+    fvalues_set(f -> values, position, value);
 }
 
 /**
@@ -746,10 +1674,248 @@ void fplus_sub2value_sopp(fplus_t* f, int index, int decrement){
  * @param index The input given as a decimal
  * @param decrement The amount to decrement
  */
-void fplus_sub2value_dsopp(fplus_t* f, int index, int decrement){
-    f -> values[index] -= decrement;
-    if(f -> values[index] < 0) {
-        f->values[index] = F_DONT_CARE_VALUE;
+void fplus_sub2value_dsopp(fplus_t* f, point_t index, int decrement){
+    long position = fplus_insert(f, index);
+    if(position < 0)
+        return;
+    int value = fplus_value_in(f, position) - decrement;
+    if(value < 0) {
+        value = F_DONT_CARE_VALUE;
+    }
+    fvalues_set(f -> values, position, value);
+}
+
+/**
+ * Subtracts the decrement to the outputs of all the points covered by the cube,
+ * as done by fplus_sub2value_sopp on each of them
+ * @param f The function
+ * @param c The cube
+ * @param decrement The amount to decrement
+ */
+void fplus_cube_sub_sopp(fplus_t* f, cube_t c, int decrement){
+    fplus_cube_sub(f, c, decrement, false);
+}
+
+/**
+ * Subtracts the decrement to the outputs of all the points covered by the cube,
+ * as done by fplus_sub2value_dsopp on each of them
+ * @param f The function
+ * @param c The cube
+ * @param decrement The amount to decrement
+ */
+void fplus_cube_sub_dsopp(fplus_t* f, cube_t c, int decrement){
+    fplus_cube_sub(f, c, decrement, true);
+}
+
+/**
+ * Subtracts the decrement to the points covered by the cube. If the function is dense the values
+ * are updated one run of consecutive points at a time, else one point at a time (missing points are added)
+ * @param disjoint true to set to don't care only the points going below 0
+ */
+void fplus_cube_sub(fplus_t* f, cube_t c, int decrement, bool disjoint){
+    if(f -> sparse != NULL || decrement < 0){
+        cword_t free_vars = ~c.care & CUBE_MASK(f -> variables);
+        cword_t subset = free_vars;
+        do{
+            if(disjoint)
+                fplus_sub2value_dsopp(f, c.value | subset, decrement);
+            else
+                fplus_sub2value_sopp(f, c.value | subset, decrement);
+            subset = (subset - 1) & free_vars;
+        }while(subset != free_vars);
+        return;
+    }
+    size_t run_size;
+    cword_t high = cube_runs(c, f -> variables, &run_size);
+    cword_t subset = 0;
+    do{
+        fvalues_sub_run(f -> values, c.value | subset, run_size, (unsigned) decrement, disjoint);
+        subset = (subset - high) & high;
+    }while(subset != 0);
+}
+
+/**
+ * @param f The function
+ * @param c The cube
+ * @return The max output of the points covered by the cube, don't cares count as 0
+ */
+unsigned fplus_cube_max(fplus_t* f, cube_t c){
+    unsigned max = 0;
+    if(f -> sparse != NULL){
+        unsigned min;
+        bool zeros, all_dont_care;
+        fplus_sparse_cube_values(f, c, &max, &min, &zeros, &all_dont_care);
+        return max;
+    }
+    size_t run_size;
+    cword_t high = cube_runs(c, f -> variables, &run_size);
+    cword_t subset = 0;
+    do{
+        unsigned run_max = fvalues_max_run(f -> values, c.value | subset, run_size);
+        max = run_max > max ? run_max : max;
+        subset = (subset - high) & high;
+    }while(subset != 0);
+    return max;
+}
+
+/**
+ * Scans the points covered by the cube with output greater than 0, in a single pass
+ * @param f The function
+ * @param c The cube
+ * @param span Will store the smallest cube covering them, c if there are none
+ * @param positives Will store their number
+ * @return Their max output, 0 if there are none (as fplus_cube_max)
+ */
+unsigned fplus_cube_span(fplus_t* f, cube_t c, cube_t* span, size_t* positives){
+    cword_t all = CUBE_MASK(f -> variables); //bits set in all the points
+    cword_t any = 0; //bits set in at least a point
+    unsigned max = 0;
+    *positives = 0;
+    if(f -> sparse != NULL){
+        cword_t free_vars = ~c.care & CUBE_MASK(f -> variables);
+        unsigned free_count = (unsigned) __builtin_popcountll(free_vars);
+        size_t points = free_count >= CWORD_BITS - 1 ? SIZE_MAX : (size_t) 1 << free_count;
+        size_t stored = fplus_size(f);
+        cword_t subset = free_vars;
+        for(size_t i = 0; points <= stored ? i < points : i < stored; i++){
+            point_t point;
+            long position;
+            if(points <= stored){
+                point = c.value | subset;
+                position = fplus_index_of(f, point);
+                subset = (subset - 1) & free_vars;
+            } else {
+                point = fplus_point_at(f, i);
+                position = cube_covers(c, point) ? (long) i : -1;
+            }
+            unsigned value = position < 0 ? 0 : fvalues_get(f -> values, position);
+            if(value > 0){
+                max = value > max ? value : max;
+                all &= point;
+                any |= point;
+                (*positives)++;
+            }
+        }
+    } else {
+        size_t run_size;
+        cword_t high = cube_runs(c, f -> variables, &run_size);
+        cword_t subset = 0;
+        do{
+            point_t start = c.value | subset;
+            for(size_t i = 0; i < run_size; i++){
+                //don't cares are stored as 0
+                unsigned value = fvalues_get(f -> values, start + i);
+                if(value > 0){
+                    max = value > max ? value : max;
+                    all &= start + i;
+                    any |= start + i;
+                    (*positives)++;
+                }
+            }
+            subset = (subset - high) & high;
+        }while(subset != 0);
+    }
+    *span = *positives > 0 ? (cube_t) {~(all ^ any) & CUBE_MASK(f -> variables), all} : c;
+    return max;
+}
+
+/**
+ * @param f The function
+ * @param c The cube
+ * @param zeros Will store true if the cube covers a point with output 0 which is not a don't care
+ * @return The min output greater than 0 of the points covered by the cube, 0 if there are none
+ */
+unsigned fplus_cube_min(fplus_t* f, cube_t c, bool* zeros){
+    unsigned min = UINT32_MAX;
+    *zeros = false;
+    if(f -> sparse != NULL){
+        unsigned max;
+        bool all_dont_care;
+        fplus_sparse_cube_values(f, c, &max, &min, zeros, &all_dont_care);
+    } else {
+        size_t run_size;
+        cword_t high = cube_runs(c, f -> variables, &run_size);
+        cword_t subset = 0;
+        do{
+            unsigned run_min = fvalues_min_run(f -> values, c.value | subset, run_size, zeros);
+            min = run_min > 0 && run_min < min ? run_min : min;
+            subset = (subset - high) & high;
+        }while(subset != 0);
+    }
+    return min == UINT32_MAX ? 0 : min;
+}
+
+/**
+ * @param f The function
+ * @param c The cube
+ * @return true if all the points covered by the cube are don't cares
+ */
+bool fplus_cube_dont_care(fplus_t* f, cube_t c){
+    if(f -> sparse != NULL){
+        unsigned max, min;
+        bool zeros, all_dont_care;
+        fplus_sparse_cube_values(f, c, &max, &min, &zeros, &all_dont_care);
+        return all_dont_care;
+    }
+    size_t run_size;
+    cword_t high = cube_runs(c, f -> variables, &run_size);
+    cword_t subset = 0;
+    do{
+        if(!fvalues_dont_care_run(f -> values, c.value | subset, run_size))
+            return false;
+        subset = (subset - high) & high;
+    }while(subset != 0);
+    return true;
+}
+
+/**
+ * Scans the points of a sparse function covered by the cube. The points of the cube are looked up
+ * one by one if they are fewer than the points stored, else the points stored are checked
+ * @param f The sparse function
+ * @param c The cube
+ * @param max Will store the max output, don't cares count as 0
+ * @param min Will store the min output greater than 0, UINT32_MAX if there are none
+ * @param zeros Will store true if a point with output 0 which is not a don't care is covered
+ * @param all_dont_care Will store true if all the points covered are don't cares
+ */
+void fplus_sparse_cube_values(fplus_t* f, cube_t c, unsigned* max, unsigned* min, bool* zeros, bool* all_dont_care){
+    cword_t free_vars = ~c.care & CUBE_MASK(f -> variables);
+    unsigned free_count = (unsigned) __builtin_popcountll(free_vars);
+    size_t points = free_count >= CWORD_BITS - 1 ? SIZE_MAX : (size_t) 1 << free_count;
+    size_t stored = fplus_size(f);
+    size_t covered = 0; //points covered stored in the function
+    *max = 0;
+    *min = UINT32_MAX;
+    *zeros = false;
+    *all_dont_care = true;
+
+    cword_t subset = free_vars;
+    size_t i = 0;
+    while(points <= stored ? i < points : i < stored){
+        long position;
+        if(points <= stored){
+            position = fplus_index_of(f, c.value | subset);
+            subset = (subset - 1) & free_vars;
+        } else
+            position = cube_covers(c, fplus_point_at(f, i)) ? (long) i : -1;
+        i++;
+        if(position < 0)
+            continue;
+        covered++;
+        if(fvalues_is_dont_care(f -> values, position))
+            continue;
+        unsigned value = fvalues_get(f -> values, position);
+        *all_dont_care = false;
+        *zeros = *zeros || value == 0;
+        if(value > 0){
+            *max = value > *max ? value : *max;
+            *min = value < *min ? value : *min;
+        }
+    }
+    //the points not stored have output 0
+    if(covered < points){
+        *zeros = true;
+        *all_dont_care = false;
     }
 }
 
@@ -761,8 +1927,7 @@ void fplus_update_non_zeros(fplus_t* f){
     int index_removed = 0;
     int i = 0;
     while(i < f -> nz_size - index_removed) {
-        int index = binary2decimal(f->non_zeros[i], f->variables);
-        if (f -> values[index] == 0) {
+        if (fplus_value_at(f, f -> non_zeros[i]) == 0) {
             index_removed++;
             f -> non_zeros[i] = f -> non_zeros[f -> nz_size - index_removed];
         }else
@@ -773,8 +1938,6 @@ void fplus_update_non_zeros(fplus_t* f){
 
 /**
  * Creates a copy of the given boolean plus function
- * Note: The copy shares with the original the actual values
- * of the bvector in f->non_zeros (the pointer is the same)
  * @param f function to copy
  * @return A new copy of the function
  */
@@ -783,17 +1946,17 @@ fplus_t* fplus_copy(fplus_t* f){
     MALLOC(f_copy, sizeof(fplus_t), ;);
     f_copy -> variables = f -> variables;
     f_copy -> nz_size = f -> nz_size;
-    unsigned long values_size = 1;
-    values_size = values_size << f -> variables;
-    MALLOC(f_copy -> values, sizeof(int) * values_size, FREE(f_copy););
+    f_copy -> sparse = NULL;
+    if(f -> sparse != NULL)
+        NULL_CHECK(f_copy -> sparse = cubeset_copy(f -> sparse));
+    NULL_CHECK(f_copy -> values = fvalues_copy(f -> values));
     if(f->nz_size == 0)
         f_copy->non_zeros = NULL;
     else {
-        MALLOC(f_copy->non_zeros, sizeof(bool *) * f->nz_size, FREE(f_copy->values);
-                FREE(f_copy););
-        memcpy(f_copy -> non_zeros, f -> non_zeros, sizeof(bool*) * f -> nz_size);
+        MALLOC(f_copy->non_zeros, sizeof(point_t) * f->nz_size, fvalues_destroy(f_copy->values);
+                cubeset_destroy(f_copy -> sparse); FREE(f_copy););
+        memcpy(f_copy -> non_zeros, f -> non_zeros, sizeof(point_t) * f -> nz_size);
     }
-    memcpy(f_copy->values, f->values, sizeof(int) * values_size);
     return f_copy;
 }
 
@@ -802,8 +1965,9 @@ fplus_t* fplus_copy(fplus_t* f){
  * @param f A function created with the method fplus_copy
  */
 void fplus_copy_destroy(fplus_t* f){
+    cubeset_destroy(f -> sparse);
     FREE(f -> non_zeros);
-    FREE(f -> values);
+    fvalues_destroy(f -> values);
     FREE(f);
 }
 
@@ -812,16 +1976,27 @@ void fplus_copy_destroy(fplus_t* f){
  * if n != 4 will print the function as a matrix
  */
 void fplus_print(fplus_t* f){
+    if(f -> sparse != NULL){
+        printf("Function points: \n");
+        for(size_t i = 0; i < fplus_size(f); i++){
+            cube_print(cube_of_point(fplus_point_at(f, i), f -> variables), f -> variables, ' ');
+            if(fvalues_is_dont_care(f -> values, i))
+                printf("\t-\n");
+            else
+                printf("\t%u\n", fvalues_get(f -> values, i));
+        }
+        return;
+    }
     if(f -> variables != 4){
         unsigned long size = 1;
         size = size << ((f->variables) >> size); //2^(f->variables)
         printf("Function table: \n");
         for(int i = 0; i < size; i++){
             for(int j = 0; j < size; j++){
-                if(f -> values[(i * size) + j] == F_DONT_CARE_VALUE)
+                if(fvalues_is_dont_care(f -> values, (i * size) + j))
                     printf("-\t");
                 else
-                    printf("%d\t", f -> values[(i * size) + j]);
+                    printf("%u\t", fvalues_get(f -> values, (i * size) + j));
             }
             printf("\n");
         }
@@ -834,13 +2009,13 @@ void fplus_print(fplus_t* f){
         for(int j = 0; j < 4; j++){
             if(i < 2)
                 if(j < 2)
-                    matrix[j][i] = f -> values[i * 4 + j];
+                    matrix[j][i] = fplus_value_at(f, i * 4 + j);
                 else
-                    matrix[4 - (j + 1)/2][i] = f -> values[i * 4 + j];
+                    matrix[4 - (j + 1)/2][i] = fplus_value_at(f, i * 4 + j);
             else if(j < 2)
-                matrix[j][4 - (i + 1)/2] = f -> values[i * 4 + j];
+                matrix[j][4 - (i + 1)/2] = fplus_value_at(f, i * 4 + j);
             else
-                matrix[4 - (j + 1)/2][4 - (i + 1)/2] = f -> values[i * 4 + j];
+                matrix[4 - (j + 1)/2][4 - (i + 1)/2] = fplus_value_at(f, i * 4 + j);
         }
     }
 
@@ -863,26 +2038,25 @@ void fplus_print(fplus_t* f){
  * @param f The function to destroy
  */
 void fplus_destroy(fplus_t* f){
-    for(int i = 0; i < f -> nz_size; i++){
-        FREE(f -> non_zeros[i]);
-    }
     FREE(f -> non_zeros);
-    FREE(f -> values);
+    fvalues_destroy(f -> values);
+    cubeset_destroy(f -> sparse);
     FREE(f);
 }
 
 
 /**
  * Creates a product plus
- * @param b A vector with the variables in the product (b[i] = true <=> variable is in the product)
- * @param variables Number of total variables (also size of above vector)
+ * @param c The cube with the literals of the product
+ * @param variables Number of total variables
  * @param coeff coefficient of the product
  * @return A pointer to the product
  */
-productp_t* productp_create(bool* b, unsigned variables, int coeff){
+productp_t* productp_create(cube_t c, unsigned variables, int coeff){
     productp_t* p;
     MALLOC(p, sizeof(productp_t), ;);
-    p -> b_product = product_create(b, variables);
+    p -> b_product.cube = c;
+    p -> b_product.variables = variables;
     p -> coeff = coeff;
     return p;
 }
@@ -893,7 +2067,7 @@ productp_t* productp_create(bool* b, unsigned variables, int coeff){
 productp_t* productp_copy(productp_t* p){
     productp_t* p_copy;
     MALLOC(p_copy, sizeof(productp_t), ;);
-    p_copy -> b_product = product_create(p -> b_product -> product, p -> b_product -> variables);
+    p_copy -> b_product = p -> b_product;
     p_copy -> coeff = p -> coeff;
     return p_copy;
 }
@@ -903,8 +2077,6 @@ productp_t* productp_copy(productp_t* p){
  * @param p The product plus
  */
 void productp_destroy(productp_t *p) {
-    FREE(p -> b_product -> product);
-    FREE(p -> b_product);
     FREE(p);
 }
 
@@ -915,139 +2087,166 @@ void productp_destroy(productp_t *p) {
  * @return
  */
 implicants_t* prime_implicants(fplus_t* f) {
-    size_t non_zeros_size = f->nz_size;
-    bvector *result = NULL; //will store prime implicants
+    return prime_implicants_wthreads(f, 1);
+}
+
+/**
+ * Quine–McCluskey algorithm for finding prime implicants using more threads.
+ * Cubes are bucketed by class (number of positive literals), each class is a hash set so that
+ * every cube is joined only with the neighbours found by setting one of its negative literals.
+ * A join has the same class of its lower cube, so the next buckets are filled directly.
+ * Each cycle the classes are split in chunks that are joined by the workers in their own buffers,
+ * the buffers are then merged in order, so the result is the same for any number of threads
+ * @param f The function
+ * @param threads The number of worker threads, 0 to use one for each online processor
+ * @return The prime implicants, NULL if the memory ran out
+ */
+implicants_t* prime_implicants_wthreads(fplus_t* f, unsigned threads) {
+    cube_t *result = NULL; //will store prime implicants
     size_t result_size = 0; //will store number of prime implicants
-    alist_t *old_list_2free = NULL;
 
-    if(non_zeros_size > 0){
-        bvector *non_zeros;
-        MALLOC(non_zeros, sizeof(bvector) * non_zeros_size, ;);
-        memcpy(non_zeros, f->non_zeros, sizeof(bvector) * non_zeros_size);
+    if(threads == 0) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = online > 0 ? (unsigned) online : 1;
+    }
+
+    if(f->nz_size > 0){
+        unsigned n_classes = f->variables + 1;
+        cubeset_t* classes[n_classes]; //cubes of the current cycle, classes[k] has the cubes with k positive literals
+        cubeset_t* next_classes[n_classes]; //implicants found in the current cycle
+        size_t class_start[n_classes + 1]; //offset of each class in taken
+        for (unsigned k = 0; k < n_classes; k++) {
+            classes[k] = cubeset_create(f->nz_size / n_classes);
+            next_classes[k] = cubeset_create(f->nz_size / n_classes);
+        }
+        cubeset_t* primes = cubeset_create(f->nz_size); //implicants that have not been joined
+        bool created = primes != NULL;
+        for (unsigned k = 0; k < n_classes; k++)
+            created = created && classes[k] != NULL && next_classes[k] != NULL;
+        if (!created) {
+            fprintf(stderr, "Error: null pointer\n");
+            join_classes_destroy(classes, next_classes, n_classes);
+            cubeset_destroy(primes);
+            return NULL;
+        }
+
+        for (size_t i = 0; i < f->nz_size; i++) {
+            cube_t c = cube_of_point(f->non_zeros[i], f->variables);
+            cubeset_add(classes[cube_norm1(c)], c);
+        }
+
+        join_work_t work;
+        work.f = f;
+        work.classes = classes;
+        work.n_classes = n_classes;
+        work.class_start = class_start;
+        work.taken = NULL; //stores if a cube of the current cycle has been joined at least one time with another
+        work.first_cycle = true;
+        work.chunks = NULL;
+        work.failed = false;
+        size_t taken_max = 0;
+        size_t chunks_max = 0;
+        pthread_t* workers;
+        MALLOC(workers, sizeof(pthread_t) * threads,
+               join_classes_destroy(classes, next_classes, n_classes); cubeset_destroy(primes));
+        pthread_mutex_init(&work.lock, NULL);
 
         while (true) {
-            int norms[non_zeros_size]; //will contain norm of each vector
-            //sort non zero values
-            my_quicksort(non_zeros, 0, (int) non_zeros_size - 1, f->variables, norms);
-
-            //stores if the corresponding element inside non_zeros has been joined at least one time with another
-            bool taken[non_zeros_size];
-            memset(taken, 0, sizeof(bool) * non_zeros_size);
-
-            alist_t *impl_found = alist_create(); //current list of implicants
-
-            //join matching vectors
-            for (size_t i = 0; i < non_zeros_size; i++) {
-                size_t j = i + 1;
-                int current_elem_class = norms[i];
-                int class_has_changed = false;
-                while (!class_has_changed && j < non_zeros_size) {
-                    if (norms[j] == current_elem_class)
-                        j++;
-                    else if (norms[j] > current_elem_class + 1)
-                        class_has_changed = true;
-                    else {
-                        if(!old_list_2free &&
-                            fplus_value_of(f, non_zeros[i]) == F_DONT_CARE_VALUE &&
-                            fplus_value_of(f, non_zeros[j]) == F_DONT_CARE_VALUE){
-                            //if they both cover don't care points
-                            taken[i] = true;
-                            taken[j] = true;
-                        }else {
-                            bvector elem = joinable_vectors(non_zeros[i], non_zeros[j], f->variables);
-                            if (elem) {
-                                taken[i] = true;
-                                taken[j] = true;
-                                alist_add(impl_found, elem, sizeof(bvector));
-                            }
-                        }
-                        j++;
-                    }
-                }
+            //split the classes in chunks
+            class_start[0] = 0;
+            work.n_chunks = 0;
+            for (unsigned k = 0; k < n_classes; k++) {
+                class_start[k + 1] = class_start[k] + cubeset_length(classes[k]);
+                work.n_chunks += (cubeset_length(classes[k]) + PI_CHUNK_SIZE - 1) / PI_CHUNK_SIZE;
             }
-
-            //case last cycle
-            if (alist_length(impl_found) == 0) {
-                if (!old_list_2free) {
-                    //only one cycle was made
-                    MALLOC(result, sizeof(bvector) * non_zeros_size, ;);
-                    for (size_t i = 0; i < non_zeros_size; i++) {
-                        MALLOC(result[i], sizeof(bool) * f->variables, FREE(result);
-                                FREE(non_zeros));
-                        memcpy(result[i], non_zeros[i], sizeof(bool) * f->variables);
-                    }
-                    FREE(non_zeros);
-                } else {
-                    MALLOC(result, sizeof(bvector) * non_zeros_size, ;);
-                    memcpy(result, non_zeros, sizeof(bvector) * non_zeros_size);
-                    alist_destroy(old_list_2free);
+            if (class_start[n_classes] > taken_max) {
+                taken_max = class_start[n_classes];
+                REALLOC(work.taken, sizeof(bool) * taken_max, work.failed = true; break);
+            }
+            if (work.n_chunks > chunks_max) {
+                chunks_max = work.n_chunks;
+                REALLOC(work.chunks, sizeof(join_chunk_t) * chunks_max, work.failed = true; break);
+            }
+            size_t c = 0;
+            for (unsigned k = 0; k < n_classes; k++) {
+                for (size_t i = 0; i < cubeset_length(classes[k]); i += PI_CHUNK_SIZE) {
+                    work.chunks[c].k = k;
+                    work.chunks[c].start = i;
+                    work.chunks[c].end = i + PI_CHUNK_SIZE < cubeset_length(classes[k]) ?
+                            i + PI_CHUNK_SIZE : cubeset_length(classes[k]);
+                    work.chunks[c].joins = NULL;
+                    work.chunks[c].joins_size = 0;
+                    work.chunks[c].joins_max = 0;
+                    c++;
                 }
-                result_size = non_zeros_size;
-                alist_destroy(impl_found);
-                break;
             }
 
-            //add implicants that have not been joined
-            for (size_t i = 0; i < non_zeros_size; i++) {
-                if (!taken[i]) {
-                    bvector b;
-                    MALLOC(b, sizeof(bool) * f->variables, ;); //TODO: add more clean up
-                    memcpy(b, non_zeros[i], sizeof(bool) * f->variables);
-                    alist_add(impl_found, b, sizeof(bvector));
-                }
+            //join the chunks
+            work.next_chunk = 0;
+            unsigned n_workers = threads < work.n_chunks ? threads : (unsigned) work.n_chunks;
+            unsigned started = 0;
+            while (started + 1 < n_workers && pthread_create(workers + started, NULL, join_worker, &work) == 0)
+                started++;
+            join_worker(&work);
+            for (unsigned t = 0; t < started; t++)
+                pthread_join(workers[t], NULL);
+
+            //merge the joins found in the order of the chunks
+            for (c = 0; c < work.n_chunks; c++) {
+                for (size_t i = 0; i < work.chunks[c].joins_size && !work.failed; i++)
+                    cubeset_add(next_classes[work.chunks[c].k], work.chunks[c].joins[i]);
+                FREE(work.chunks[c].joins);
             }
+            if (work.failed)
+                break;
 
-            //free list used in last cycle
-            if (old_list_2free) {
-                alist_for_each(old_list_2free, free_f);
-                alist_destroy(old_list_2free);
-            } else
-                //if first cycle
-                FREE(non_zeros);
-
-            old_list_2free = impl_found;
-
-            //set as new array the joint implicants found
-            non_zeros = alist_as_array(impl_found, &non_zeros_size);
-
-            //delete duplicates
-            int duplicates_found = 0;
-            for (size_t i = 0; i < non_zeros_size - 1 - duplicates_found; i++) {
-                for (size_t j = i + 1; j < non_zeros_size - duplicates_found; j++) {
-                    if (bvector_equals(non_zeros[i], non_zeros[j], f->variables)) {
-                        duplicates_found++;
-                        FREE(non_zeros[j]);
-                        non_zeros[j] = non_zeros[non_zeros_size - duplicates_found];
-                        non_zeros[non_zeros_size - duplicates_found] = NULL;
-                        j--; //recheck current element
-                    }
+            //implicants that have not been joined are prime, cubes that cover only don't care points are skipped
+            size_t found = 0;
+            for (unsigned k = 0; k < n_classes; k++) {
+                size_t class_size;
+                cube_t* cubes = cubeset_as_array(classes[k], &class_size);
+                for (size_t i = 0; i < class_size; i++) {
+                    if (!work.taken[class_start[k] + i] &&
+                        (!work.first_cycle || !fplus_is_dont_care(f, cubes[i].value)))
+                        cubeset_add(primes, cubes[i]);
                 }
+
+                //the implicants found are the classes of the next cycle
+                cubeset_t* tmp = classes[k];
+                classes[k] = next_classes[k];
+                next_classes[k] = tmp;
+                cubeset_clear(next_classes[k]);
+                found += cubeset_length(classes[k]);
             }
-            non_zeros_size -= duplicates_found;
+            work.first_cycle = false;
 
+            //case last cycle
+            if (found == 0)
+                break;
         }
 
-        //delete duplicates
-        int duplicates_found = 0;
-        for (int i = 0; i < result_size - 1 - duplicates_found; i++) {
-            for (int j = i + 1; j < result_size - duplicates_found; j++) {
-                if (bvector_equals(result[i], result[j], f->variables)) {
-                    duplicates_found++;
-                    FREE(result[j]);
-                    result[j] = result[result_size - duplicates_found];
-                    result[result_size - duplicates_found] = NULL;
-                    j--;
-                }
-            }
+        join_classes_destroy(classes, next_classes, n_classes);
+        FREE(work.taken);
+        FREE(work.chunks);
+        FREE(workers);
+        pthread_mutex_destroy(&work.lock);
+        if (work.failed) {
+            cubeset_destroy(primes);
+            return NULL;
+        }
+
+        result_size = cubeset_length(primes);
+        if (result_size > 0) {
+            MALLOC(result, sizeof(cube_t) * result_size, cubeset_destroy(primes));
+            memcpy(result, cubeset_as_array(primes, NULL), sizeof(cube_t) * result_size);
         }
-        result_size -= duplicates_found;
+        cubeset_destroy(primes);
     }
 
     //create implicants object
-    REALLOC(result, sizeof(bvector) * result_size, ;);
     implicants_t* implicants;
-    MALLOC(implicants, sizeof(implicants_t), FREE(result)); //TODO: should clean more stuff
-    implicants -> bvectors = result;
+    MALLOC(implicants, sizeof(implicants_t), FREE(result));
+    implicants -> cubes = result;
     implicants -> size = result_size;
     implicants -> variables = f -> variables;
 
@@ -1055,100 +2254,99 @@ implicants_t* prime_implicants(fplus_t* f) {
 }
 
 /**
- * Standard partition function for quicksort adapted to a bvector
- * If norms != NULL, the norm of the vectors are stored at the corresponding
- * index of the vector
+ * Destroys the class sets of prime_implicants_wthreads, the ones not created are NULL
  */
-int partition (bvector* arr, int low, int high, unsigned variables, int* norms){
-    // pivot (Element to be placed at right position)
-    bvector pivot = arr[high];
-    int norm_pivot = norm1(pivot, variables); //get norm1 of vector
-
-    int i = (low - 1);  // Index of smaller element
-
-    for (int j = low; j < high; j++) {
-        int norm_other = norm1(arr[j], variables);
-
-        // If current element is smaller than the pivot
-        if(norm_other < norm_pivot){
-            i++;    // increment index of smaller element
-            bvector tmp = arr[i];
-            arr[i] = arr[j];
-            arr[j] = tmp;
-            if(norms)
-                norms[i] = norm_other;
-        } else if(norms)
-            norms[j] = norm_other;
-    }
-
-    bvector tmp = arr[i + 1];
-    arr[i + 1] = arr[high];
-    arr[high] = tmp;
-    if(norms) {
-        norms[high] = norm1(arr[i + 1], variables);
-        norms[i + 1] = norm_pivot;
+void join_classes_destroy(cubeset_t** classes, cubeset_t** next_classes, unsigned n_classes){
+    for (unsigned k = 0; k < n_classes; k++) {
+        cubeset_destroy(classes[k]);
+        cubeset_destroy(next_classes[k]);
     }
-    return i + 1;
 }
 
 /**
- * custom quicksort, compares a array of bool vectors using their norm 1.
- * For each element e, it stores in norms the sum(e(i)) for later use
- * @param arr The bvector array to sort
- * @param low The lowest index (0)
- * @param high The highest index (size - 1)
- * @param variables The number of variables of each bvector
- * @param norms If != NULL will be an array storing the norms of the vectors
+ * Worker of prime_implicants_wthreads, joins chunks until there are none left
+ * @param arg The join_work_t shared by the workers
+ * @return NULL
  */
-void my_quicksort(bvector* arr, int low, int high, unsigned variables, int* norms) {
-    if (low < high) {
-        int pi = partition(arr, low, high, variables, norms);
-        my_quicksort(arr, low, pi - 1, variables, norms);  // Before pi
-        my_quicksort(arr, pi + 1, high, variables, norms); // After pi
+void* join_worker(void* arg){
+    join_work_t* work = arg;
+    while (true) {
+        pthread_mutex_lock(&work->lock);
+        size_t c = work->next_chunk++;
+        pthread_mutex_unlock(&work->lock);
+        if (c >= work->n_chunks)
+            return NULL;
+        if (!join_chunk(work, work->chunks + c)) {
+            pthread_mutex_lock(&work->lock);
+            work->failed = true;
+            pthread_mutex_unlock(&work->lock);
+        }
     }
 }
 
 /**
- * Frees a given heap pointer
- * Used to call alist_for_each
- * @param p The pointer
- * @param s The size of the memory, will be set to 0 after free
- * @return always true
+ * Joins each cube of the chunk with its neighbours in the next class, storing the joins in the chunk.
+ * A cube is taken if it has a neighbour in the next or in the previous class, so that each
+ * worker writes only the flags of its own chunk
+ * @param work The shared state of the current cycle
+ * @param chunk The chunk to join
+ * @return false if a join could not be stored
  */
-int free_f(void* p, size_t* s){
-    FREE(p);
-    *s = 0;
-    return 1;
+bool join_chunk(join_work_t* work, join_chunk_t* chunk){
+    unsigned k = chunk->k;
+    cube_t* cubes = cubeset_as_array(work->classes[k], NULL);
+    cubeset_t* next = k + 1 < work->n_classes && cubeset_length(work->classes[k + 1]) > 0 ?
+            work->classes[k + 1] : NULL;
+    cubeset_t* previous = k > 0 && cubeset_length(work->classes[k - 1]) > 0 ? work->classes[k - 1] : NULL;
+
+    for (size_t i = chunk->start; i < chunk->end; i++) {
+        bool taken = false;
+        cword_t negatives = next ? cubes[i].care & ~cubes[i].value : 0;
+        while (negatives) {
+            cword_t literal = negatives & -negatives;
+            negatives ^= literal;
+            cube_t neighbour = {cubes[i].care, cubes[i].value | literal};
+            if (!cubeset_contains(next, neighbour))
+                continue;
+            taken = true;
+            //if they both cover don't care points they are not joined
+            if(!work->first_cycle ||
+                !fplus_is_dont_care(work->f, cubes[i].value) ||
+                !fplus_is_dont_care(work->f, neighbour.value)){
+                cube_t elem = {cubes[i].care & ~literal, cubes[i].value};
+                if (!cubes_append(&chunk->joins, &chunk->joins_size, &chunk->joins_max, elem))
+                    return false;
+            }
+        }
+
+        cword_t positives = previous && !taken ? cubes[i].value : 0;
+        while (positives && !taken) {
+            cword_t literal = positives & -positives;
+            positives ^= literal;
+            cube_t neighbour = {cubes[i].care, cubes[i].value & ~literal};
+            taken = cubeset_contains(previous, neighbour);
+        }
+        work->taken[work->class_start[k] + i] = taken;
+    }
+    return true;
 }
 
 /**
- * Checks if the two vectors are joinable
- * Two vectors v1, v2 are joinable <=> Exists j / v1(j) = !v2(j) and for each i != j v1(i) = v2(i)
- * The joined vector will be equal to v1(or v2) for each i != j and will a dash value for i = j
- * @param size The size of the vectors
- * @return The joined vector (in heap) if possible, NULL otherwise
+ * Adds a cube at the end of a heap array, growing it if needed
+ * @param array The array, may be NULL if max_size is 0
+ * @param size The number of cubes in the array, will be incremented
+ * @param max_size The number of cubes the array can store, updated if the array grows
+ * @param c The cube to add
+ * @return The outcome of the operation
  */
-bvector joinable_vectors(const bool* v1, const bool* v2, unsigned variables){
-    bool* join;
-    MALLOC(join, sizeof(bool) * variables, ;);
-
-    int counter = 0; //counts the complimentary bits found
-    for(int i = 0; i < variables; i++){
-        if(v1[i] == v2[i]){
-            join[i] = v1[i];
-        }else if(v1[i] == dash || v2[i] == dash) {
-            FREE(join);
-            return NULL;
-        }else{
-            counter++;
-            if(counter > 1) {
-                FREE(join);
-                return NULL; //are not joinable
-            }
-            join[i] = dash;
-        }
+bool cubes_append(cube_t** array, size_t* size, size_t* max_size, cube_t c){
+    if(*size == *max_size){
+        size_t new_max = *max_size == 0 ? PI_CHUNK_SIZE : *max_size * 2;
+        REALLOC(*array, sizeof(cube_t) * new_max, return false);
+        *max_size = new_max;
     }
-    return join;
+    (*array)[(*size)++] = c;
+    return true;
 }
 
 /**
@@ -1161,13 +2359,10 @@ implicants_t* implicants_copy(implicants_t* impl){
     i_copy->size = impl->size;
     i_copy->variables = impl->variables;
     if(impl->size == 0)
-        i_copy->bvectors = NULL;
+        i_copy->cubes = NULL;
     else {
-        MALLOC(i_copy->bvectors, sizeof(bool *) * impl->size, FREE(i_copy));
-        for (int i = 0; i < impl->size; i++) {
-            MALLOC(i_copy->bvectors[i], sizeof(bool) * impl->variables, ;);//TODO: improve clean
-            memcpy(i_copy->bvectors[i], impl->bvectors[i], sizeof(bool) * impl->variables);
-        }
+        MALLOC(i_copy->cubes, sizeof(cube_t) * impl->size, FREE(i_copy));
+        memcpy(i_copy->cubes, impl->cubes, sizeof(cube_t) * impl->size);
     }
     return i_copy;
 }
@@ -1180,70 +2375,72 @@ implicants_t* implicants_copy(implicants_t* impl){
  * @return true if at least an implicant in source has been removed
  */
 bool remove_implicant_duplicates(implicants_t* source, implicants_t* to_remove, fplus_t* f){
+    arena_t* arena;
+    NULL_CHECK(arena = arena_create(ARENA_BLOCK_SIZE));
+    bool removed = remove_implicant_duplicates_wbudget_warena(source, to_remove, f, NULL, arena);
+    arena_destroy(arena);
+    return removed;
+}
+
+/**
+ * Same as remove_implicant_duplicates, the budget is checked before each implicant of to_remove:
+ * when it is over the remaining duplicates are kept, all the new implicants are still added.
+ * The points of each implicant of source are scanned once: all its non zero points are covered by an
+ * implicant of to_remove if and only if this contains the smallest cube covering them (its span),
+ * so each pair is then checked with a single cube_contains. The spans are allocated in the arena
+ * @param source The original implicants. May have some implicants covering 0 or don't care point
+ * @param to_remove New implicants, covering only non zero points
+ * @param f The boolean plus function
+ * @param budget The budget, NULL for no limit
+ * @param arena The arena, the memory taken is released before returning
+ * @return true if at least an implicant in source has been removed, false if the budget is over
+ */
+bool remove_implicant_duplicates_wbudget_warena(implicants_t* source, implicants_t* to_remove, fplus_t* f,
+                                                budget_t* budget, arena_t* arena){
     int removed = 0; //stores the number of removed implicants from source
-    int non_zero_values = 0; //stores the number of non zero values encountered. if = 0 => no need to go on
+    bool non_zero_values = false; //true if a non zero value was encountered, else there is no need to go on
+
+    arena_mark_t mark = arena_mark(arena);
+    size_t spans_size = source -> size > 0 ? (size_t) source -> size : 1;
+    cube_t* spans; //smallest cube covering the non zero points of each implicant in source
+    size_t* positives; //number of non zero points of each implicant in source
+    NULL_CHECK(spans = arena_alloc(arena, sizeof(cube_t) * spans_size));
+    NULL_CHECK(positives = arena_alloc(arena, sizeof(size_t) * spans_size));
+    for(int j = 0; j < source -> size; j++)
+        fplus_cube_span(f, source -> cubes[j], spans + j, positives + j);
 
     /*
      * for each implicant in to_remove checks if it covers all the non_zero points
      * of a implicant in source. In that case the implicant in source is removed
      */
-    for(int i = 0; i < to_remove -> size; i++){
-        //get all the points covered by the implicant in to_remove
-        int r_size; //remove size
-        int* r_indexes = binary2decimals(to_remove -> bvectors[i], to_remove -> variables, &r_size);
+    bool over = false;
+    for(int i = 0; i < to_remove -> size && !(over = budget_over(budget)); i++){
         int j = 0;
         while(j < source -> size - removed){
-            //get all the points covered by the implicant in source
-            int s_size; //source zie
-            int* s_indexes = binary2decimals(source -> bvectors[j], source -> variables, &s_size);
-
+            non_zero_values = non_zero_values || positives[j] > 0;
             //if all non_zero points of s are covered by r
-            if(r_cover_s(r_indexes, r_size, s_indexes, s_size, f, &non_zero_values)){
+            if(positives[j] == 0 || cube_contains(to_remove -> cubes[i], spans[j])){
                 removed++;
-                FREE(source->bvectors[j]);
-                source -> bvectors[j] = source -> bvectors[source->size - removed];
+                int last = source -> size - removed;
+                source -> cubes[j] = source -> cubes[last];
+                spans[j] = spans[last];
+                positives[j] = positives[last];
             }else
                 j++;
-            FREE(s_indexes);
         }
-        FREE(r_indexes);
     }
     source -> size -= removed;
+    arena_rewind(arena, mark);
 
     //add all implicants in to_remove to source
-    REALLOC(source -> bvectors, sizeof(bvector) * (source -> size + to_remove -> size), ;);
-    for(int i = source -> size; i < source->size + to_remove->size; i++){
-        source->bvectors[i] = to_remove->bvectors[i - source->size];
-    }
+    REALLOC(source -> cubes, sizeof(cube_t) * (source -> size + to_remove -> size), ;);
+    if(to_remove -> size > 0)
+        memcpy(source -> cubes + source -> size, to_remove -> cubes, sizeof(cube_t) * to_remove -> size);
     source -> size += to_remove -> size;
-    if(source -> size == to_remove -> size) {
+    if(source -> size == to_remove -> size || over) {
         return false;
     }
-    return non_zero_values > 0;
-}
-
-/**
- * @param r_indexes The points of r as decimal
- * @param r_size The number of points of r
- * @param s_indexes The points of s as decimal
- * @param s_size The number of points of s
- * @param f The function which output to check
- * @param non_zero_values Will store the number of non-zero values found
- * @return true if all non_zero points of s are covered by r
- */
-bool r_cover_s(const int *r_indexes, int r_size, int *s_indexes, int s_size, fplus_t *f, int* non_zero_values) {
-    int i = 0; //index of r_indexes
-    for(int k = 0; k < s_size; k++){
-        if(fplus_value_at(f, s_indexes[k]) > 0){
-            (*non_zero_values)++;
-            while(i < r_size && r_indexes[i] > s_indexes[k])
-                i++;
-            if(i == r_size || r_indexes[i] != s_indexes[k]) {
-                return false;
-            }
-        }
-    }
-    return true;
+    return non_zero_values;
 }
 
 /**
@@ -1252,35 +2449,18 @@ bool r_cover_s(const int *r_indexes, int r_size, int *s_indexes, int s_size, fpl
 void implicants_print(implicants_t* impl){
     printf("Implicants: \n");
     for(int i = 0; i < impl -> size; i++){
-        for(int j = 0; j < impl -> variables; j++){
-            if(impl -> bvectors[i][j] > 1)
-                printf("-\t");
-            else
-                printf("%d\t", impl -> bvectors[i][j]);
-        }
+        cube_print(impl -> cubes[i], impl -> variables, '\t');
         printf("\n");
     }
     printf("\n");
 }
 
-/**
- * Frees the memory used by an implicant leaving the memory
- * used by each element of impl->implicants
- */
-void implicants_soft_destroy(implicants_t* impl){
-    FREE(impl -> bvectors);
-    FREE(impl);
-}
-
 /**
  * Frees the memory used by implicants plus
  * @param impl The implicants to free
  */
 void implicants_destroy(implicants_t* impl){
-    for(int i = 0; i < impl -> size; i++){
-        FREE(impl -> bvectors[i]);
-    }
-    FREE(impl -> bvectors);
+    FREE(impl -> cubes);
     FREE(impl);
 }
 
@@ -1290,39 +2470,70 @@ void implicants_destroy(implicants_t* impl){
  * @return a pointer to a struct containing the essential points and the essential prime implicants
  */
 essentialsp_t* essential_implicants(fplus_t* f, implicants_t* implicants){
-    unsigned long f_size = 1;
-    f_size = f_size << (f -> variables);
-    //each index represents a point of f, the list will contain the implicants covering that point
-    alist_t* points[f_size];
-    bvector essential_implicants[f_size]; //stores the essential prime implicants
-    int e_index = 0; //index of above and below array;
-    bvector* essential_points; //stores the essential points
-    MALLOC(essential_points, sizeof(bvector) * f_size, ;);
-
-    //init the array of points
-    for(size_t i = 0; i < f_size; i++){
-        points[i] = alist_create();
-    }
+    arena_t* arena;
+    NULL_CHECK(arena = arena_create(ARENA_BLOCK_SIZE));
+    essentialsp_t* e = essential_implicants_warena(f, implicants, arena);
+    arena_destroy(arena);
+    return e;
+}
 
-    //count occurrences of various points
+/**
+ * Same as essential_implicants, the temporary arrays are allocated in the arena
+ * @param arena The arena, the memory taken is released before returning
+ */
+essentialsp_t* essential_implicants_warena(fplus_t* f, implicants_t* implicants, arena_t* arena){
+    size_t f_size = fplus_size(f);
+    size_t nz_size = f -> nz_size > 0 ? f -> nz_size : 1;
+    arena_mark_t mark = arena_mark(arena);
+    //each position of f -> values represents a point of f, it stores the implicant covering that point:
+    //COVERED_BY_NONE, COVERED_BY_MANY or the position of the only one in implicants
+    int* coverer;
+    cube_t** essential_implicants; //stores the essential prime implicants
+    int e_index = 0; //index of above and below array;
+    point_t* essential_points; //stores the essential points
+    NULL_CHECK(coverer = arena_alloc(arena, sizeof(int) * f_size));
+    NULL_CHECK(essential_implicants = arena_alloc(arena, sizeof(cube_t*) * nz_size));
+    MALLOC(essential_points, sizeof(point_t) * nz_size, arena_rewind(arena, mark));
+    for(size_t i = 0; i < f_size; i++)
+        coverer[i] = COVERED_BY_NONE;
+
+    //record the implicants covering each point
     for(int i = 0; i < implicants -> size; i++){
-        int size = 0;
-        int* indexes = binary2decimals(implicants -> bvectors[i], f -> variables, &size);
-        for(int j = 0; j < size; j++){
-            alist_add(points[indexes[j]], implicants->bvectors[i], sizeof(bvector));
+        cube_t c = implicants -> cubes[i];
+        cword_t free_vars = ~c.care & CUBE_MASK(f -> variables);
+        unsigned free_count = (unsigned) __builtin_popcountll(free_vars);
+        if(f -> sparse != NULL && free_count < CWORD_BITS && ((size_t) 1 << free_count) <= f_size){
+            //fewer points than the ones stored, each one is looked up
+            cword_t subset = free_vars;
+            do{
+                long index = fplus_index_of(f, c.value | subset);
+                if(index >= 0) //else point with value 0 not stored
+                    coverer[index] = coverer[index] == COVERED_BY_NONE ? i : COVERED_BY_MANY;
+                subset = (subset - 1) & free_vars;
+            }while(subset != free_vars);
+        } else if(f -> sparse != NULL){
+            for(size_t j = 0; j < f_size; j++)
+                if(cube_covers(c, fplus_point_at(f, j)))
+                    coverer[j] = coverer[j] == COVERED_BY_NONE ? i : COVERED_BY_MANY;
+        } else {
+            cword_t subset = free_vars;
+            do{
+                point_t point = c.value | subset;
+                coverer[point] = coverer[point] == COVERED_BY_NONE ? i : COVERED_BY_MANY;
+                subset = (subset - 1) & free_vars;
+            }while(subset != free_vars);
         }
-        FREE(indexes);
     }
 
     //store points and implicants in array
     for(int i = 0; i < f -> nz_size; i++){
-        int index = binary2decimal(f -> non_zeros[i], f -> variables);
-        int l_size = alist_length(points[index]);
-        if(fplus_value_of(f, f->non_zeros[i]) != F_DONT_CARE_VALUE) {
-            if (l_size == 0) {
+        long index = fplus_index_of(f, f -> non_zeros[i]);
+        int covered_by = index < 0 ? COVERED_BY_NONE : coverer[index];
+        if(!fplus_is_dont_care(f, f->non_zeros[i])) {
+            if (covered_by == COVERED_BY_NONE) {
                 fprintf(stderr, "Some error occurred, an essential point has not been covered\n");
-            } else if (l_size == 1) {
-                essential_implicants[e_index] = alist_get(points[index], 0, 0);
+            } else if (covered_by != COVERED_BY_MANY) {
+                essential_implicants[e_index] = implicants -> cubes + covered_by;
                 essential_points[e_index++] = f->non_zeros[i];
             }
         }
@@ -1337,7 +2548,7 @@ essentialsp_t* essential_implicants(fplus_t* f, implicants_t* implicants){
         e = NULL;
     } else {
         MALLOC(e, sizeof(essentialsp_t), FREE(essential_points););
-        REALLOC(essential_points, sizeof(bvector) * e_index, ;);
+        REALLOC(essential_points, sizeof(point_t) * e_index, ;);
         final_implicants = implicants2sop(essential_implicants, e_index, f->variables, &e->impl_size);
 
         e->implicants = final_implicants;
@@ -1345,58 +2556,33 @@ essentialsp_t* essential_implicants(fplus_t* f, implicants_t* implicants){
         e->points_size = e_index;
     }
 
-    for(size_t i = 0; i < f_size; i++) {
-        alist_destroy(points[i]);
-    }
+    arena_rewind(arena, mark);
     return e;
 }
 
 /**
- * Converts a boolean vector array to a product array
- * Also removes duplicates if found (O(n^2), may be improved)
+ * Converts a cube array to a product array
+ * Also removes duplicates if found, keeping the first occurrence
  * @param final_size Sets in this variable the size without the duplicates
  * @return The newly created array
  */
-productp_t** implicants2sop(bvector* implicants, int size, unsigned variables, int* final_size){
-    int duplicates[size];
-    int duplicates_found = 0;
-    memset(duplicates, 0, sizeof(int) * size);
-
-    //tag duplicates
-    for(int i = 0; i < size - 1; i++){
-        if(!duplicates[i])
-            for(int j = i + 1; j < size; j++) {
-                if (bvector_equals(implicants[i], implicants[j], variables)) {
-                    if (!duplicates[j]) {
-                        duplicates[j] = true;
-                        duplicates_found++;
-                    }
-                }
-            }
-    }
-
+productp_t** implicants2sop(cube_t** implicants, int size, unsigned variables, int* final_size){
+    cubeset_t* unique;
+    NULL_CHECK(unique = cubeset_create(size));
+    for(int i = 0; i < size; i++)
+        cubeset_add(unique, *implicants[i]);
+
+    size_t unique_size;
+    cube_t* cubes = cubeset_as_array(unique, &unique_size);
     productp_t** product_array;
-    MALLOC(product_array, sizeof(productp_t*) * (size - duplicates_found), ;);
-    int array_index = 0;
+    MALLOC(product_array, sizeof(productp_t*) * unique_size, cubeset_destroy(unique));
 
     //copy only non duplicates
-    for(int i = 0; i < size; i++){
-        if(!duplicates[i]) {
-            for (int j = 0; j < variables; j++) {
-                if (implicants[i][j] == dash) //write in new variable
-                    implicants[i][j] = not_present;
-            }
-            product_array[array_index] = productp_create(implicants[i], variables, 1);
-            array_index++;
-            for (int j = 0; j < variables; j++) {
-                if (implicants[i][j] == not_present) //write in new variable
-                    implicants[i][j] = dash;
-            }
-        }
-    }
-
-    *final_size = size - duplicates_found;
+    for(size_t i = 0; i < unique_size; i++)
+        product_array[i] = productp_create(cubes[i], variables, 1);
 
+    *final_size = (int) unique_size;
+    cubeset_destroy(unique);
     return product_array;
 }
 
@@ -1408,18 +2594,14 @@ productp_t** implicants2sop(bvector* implicants, int size, unsigned variables, i
 void essentials_print(essentialsp_t* e, unsigned variables){
     printf("Essential implicants: \n");
     for(int i = 0; i < e -> impl_size; i++){
-        for(int j = 0; j < variables; j++){
-            printf("%d\t", e -> implicants[i] -> b_product -> product[j]);
-        }
+        cube_print(e -> implicants[i] -> b_product.cube, variables, '\t');
         printf("\n");
     }
     printf("\n");
 
     printf("Essential points: \n");
     for(int i = 0; i < e -> points_size; i++){
-        for(int j = 0; j < variables; j++){
-            printf("%d\t", e -> points[i][j]);
-        }
+        cube_print(cube_of_point(e -> points[i], variables), variables, '\t');
         printf("\n");
     }
     printf("\n");
@@ -1435,4 +2617,4 @@ void essentials_destroy(essentialsp_t* e){
     FREE(e -> implicants);
     FREE(e -> points);
     FREE(e);
-}
\ No newline at end of file
+}
@@ -16,44 +16,83 @@
 //value for don't care point in f
 #define F_DONT_CARE_VALUE (-1)
 
+//max variables of a function: products are packed in a single word (cube_t), so the fplus_create* functions
+//return NULL for more variables. A dense function also stores 2^variables outputs, so it takes fewer than this
+#define FPLUS_MAX_VARIABLES CWORD_BITS
+
 //distribution of don't care values when building a random fplus
 #define PROBABILITY_UNDEFINED 50
 
-//parameter for sopp representation in semi-hashtable
+//variables of the chunks of points filled by each worker when building a random fplus
+#define RANDOM_CHUNK_VARIABLES 16
+
+//parameter for sopp representation in hashtable, the table grows when the load exceeds GOOD_LOAD
 #define INIT_SIZE 100
 #define GOOD_LOAD 0.5
 
+//number of cubes joined by a worker at a time when finding prime implicants
+#define PI_CHUNK_SIZE 1024
+
+//values of the coverer of a point in essential_implicants, when it is not covered by exactly one implicant
+#define COVERED_BY_NONE (-1)
+#define COVERED_BY_MANY (-2)
+
+//words of bit slices (64 inputs each) evaluated at a time by sopp_values_of
+#define EVAL_BLOCK_WORDS 4
+
+//engines of a portfolio synthesis, to be combined in a mask
+#define PORTFOLIO_GREEDY 1 //sopp_synthesis or dsopp_synthesis
+#define PORTFOLIO_EXPERIMENTAL 2 //sopp_synthesis_experimental or dsopp_synthesis_wexperimental
+#define PORTFOLIO_HEURISTIC 4 //sopp_synthesis_heuristic or dsopp_synthesis_wheuristic
+#define PORTFOLIO_EXACT 8 //sopp_synthesis_exact_wlimits, for sopp forms only
+#define PORTFOLIO_ENGINES 4 //number of engines above
+#define PORTFOLIO_ALL ((1 << PORTFOLIO_ENGINES) - 1)
+#define PORTFOLIO_DEFAULT (PORTFOLIO_GREEDY | PORTFOLIO_EXPERIMENTAL | PORTFOLIO_HEURISTIC)
+
+//variables of a slice of the domain checked at a time when verifying a form of a dense function
+#define FORM_SLICE_VARIABLES 16
+
+#include "arena.h"
 #include "arraylist.h"
 #include "bool_utils.h"
+#include "budget.h"
+#include "cubeset.h"
+#include "fvalues.h"
 #include "bool_plus.h"
 
 //a boolean product with a coefficient
 typedef struct{
-    bool_product* b_product;
+    bool_product b_product;
     int coeff;
 }productp_t;
 
-//a function from a vector of bool to natural numbers
+/*
+ * A function from a vector of bool to natural numbers.
+ * A dense function stores the output of each point, a sparse one only those of the points in
+ * the set 'sparse' (the others have output 0), so that it can have up to CWORD_BITS variables.
+ * The outputs are stored with the smallest width fitting them, don't care points in a bitmap
+ */
 typedef struct {
-    int* values; //stores each combination of the input
-    unsigned variables; //number of variables taken as input, 2^variables = size of above array
-    bool** non_zeros; //array with the index of non-zero values written as binary numbers
+    fvalues_t* values; //stores each combination of the input, or the i-th value = output of the i-th point of sparse
+    unsigned variables; //number of variables taken as input, 2^variables = size of above array if dense
+    point_t* non_zeros; //array with the non-zero points (don't care included) as decimals
     size_t nz_size; //size of above array
+    cubeset_t* sparse; //the points stored (as cubes with all the variables in care), NULL if dense
 }fplus_t;
 
 //stores a list of essential prime implicants and their essential points
 typedef struct {
     productp_t** implicants; //list of essential implicants
     int impl_size; //size of above list
-    bool** points; //list of point covered by the implicants
+    point_t* points; //list of point covered by the implicants, as decimals
     int points_size; //size of above list
 }essentialsp_t;
 
-//uses hashtable to store sop
+//uses hashtable to store sop, with open addressing and linear probing
 //no duplicates are allowed
 typedef struct{
-    alist_t** table; //the hashtable
-    size_t table_size; //number of buckets
+    size_t* table; //the hashtable, each slot is 0 if empty or the position + 1 of a product in arraylist
+    size_t table_size; //number of slots, a power of 2
     size_t current_length; //number of actual elements
     alist_t* arraylist; //list with all the elements
 }sopp_t; //sop plus form
@@ -67,11 +106,29 @@ sopp_t* sopp_create(); //creates a sopp with default size
 sopp_t* sopp_create_wsize(size_t expected_size); //creates a sopp with a suggested size
 bool sopp_add(sopp_t*, productp_t*); //adds a product to a sopp
 int sopp_value_of(sopp_t*, bool*); //returns the output of the sopp with the given variables values
+//writes in sums the outputs of the sopp for count inputs, given as a bit slice for each variable
+void sopp_values_of(sopp_t*, const cword_t* slices, unsigned variables, size_t count, long* sums);
+//writes in sums the outputs of the sopp for count inputs, given as decimals
+bool sopp_values_at(sopp_t*, const point_t* points, unsigned variables, size_t count, long* sums);
 bool sopp_form_of(sopp_t*, fplus_t*); //returns true if the given sopp form is valid for the given function
+bool sopp_form_of_wthreads(sopp_t*, fplus_t*, unsigned threads); //same as above using more threads
 void sopp_print(sopp_t*); //prints the sopp
 void sopp_destroy(sopp_t*); //frees the memory of a sopp form
 sopp_t* sopp_synthesis(fplus_t*); //return a minimal sopp form for the given function
 sopp_t* sopp_synthesis_experimental(fplus_t*); //sopp synthesis with minor changes to optimize time
+//same as above, the temporary memory is allocated in the given arena
+sopp_t* sopp_synthesis_warena(fplus_t*, arena_t*);
+sopp_t* sopp_synthesis_experimental_warena(fplus_t*, arena_t*);
+//same as above, stop when the budget is over and complete the form found with minterms (see budget.h)
+sopp_t* sopp_synthesis_wbudget(fplus_t*, budget_t*);
+sopp_t* sopp_synthesis_experimental_wbudget(fplus_t*, budget_t*);
+sopp_t* sopp_synthesis_heuristic(fplus_t*); //heuristic sopp synthesis for many variables, no prime implicants
+sopp_t* sopp_synthesis_heuristic_wbudget(fplus_t*, budget_t*); //same as above, stops when the budget is over
+sopp_t* sopp_synthesis_exact(fplus_t*); //sopp form with minimum weight, in exponential time
+//same as above, stops at the given limits (0 for none), optimal is set to true if the form is proved minimal
+sopp_t* sopp_synthesis_exact_wlimits(fplus_t*, unsigned threads, size_t max_nodes, double max_seconds, bool* optimal);
+//races the given engines (a mask of PORTFOLIO_*, 0 for default) on many threads, returns the lightest form
+sopp_t* sopp_synthesis_portfolio(fplus_t*, unsigned engines, double max_seconds);
 long sopp_weights_sum(sopp_t*); //returns sum of weights of sopp/dsopp form
 bool sopp_not_empty(sopp_t*); //true if the sopp has at least a product
 
@@ -79,36 +136,85 @@ bool sopp_not_empty(sopp_t*); //true if the sopp has at least a product
  * dsopp related functions
  */
 bool dsopp_form_of(dsopp_t*, fplus_t*); //returns true if the given dsopp form is valid for the given function
+bool dsopp_form_of_wthreads(dsopp_t*, fplus_t*, unsigned threads); //same as above using more threads
 dsopp_t* dsopp_synthesis(fplus_t*); //return a minimal dsopp form for the given function
 dsopp_t* dsopp_synthesis_wexperimental(fplus_t*); //dsopp synthesis with the use of sopp_synthesis_experimental
+//same as above, the temporary memory is allocated in the given arena
+dsopp_t* dsopp_synthesis_warena(fplus_t*, arena_t*);
+dsopp_t* dsopp_synthesis_wexperimental_warena(fplus_t*, arena_t*);
+//same as above, stop when the budget is over and complete the form found with minterms (see budget.h)
+dsopp_t* dsopp_synthesis_wbudget(fplus_t*, budget_t*);
+dsopp_t* dsopp_synthesis_wexperimental_wbudget(fplus_t*, budget_t*);
+dsopp_t* dsopp_synthesis_wheuristic(fplus_t*); //dsopp synthesis with the use of sopp_synthesis_heuristic
+dsopp_t* dsopp_synthesis_wheuristic_wbudget(fplus_t*, budget_t*); //same as above, stops when the budget is over
+dsopp_t* dsopp_synthesis_wsopp(fplus_t*, sopp_t*); //dsopp synthesis starting from the given sopp form of f
+dsopp_t* dsopp_synthesis_portfolio(fplus_t*, unsigned engines, double max_seconds); //same as sopp above
 void dsopp_print(dsopp_t*); //prints the dsopp
 
 
 /*
  * fplus related functions
  */
-//creates a boolean plus function with the given parameters
-fplus_t* fplus_create(int* values, bool** non_zeros, int variables, int size);
+//creates a boolean plus function with the given parameters (all the fplus_create* up to FPLUS_MAX_VARIABLES)
+fplus_t* fplus_create(int* values, point_t* non_zeros, int variables, int size);
 fplus_t* fplus_create_empty(unsigned variables); //creates an f with all don't care values
 void fplus_add_output(fplus_t*, int index, int value); //use to build from an empty function
 
-//creates a boolean plus function with random outputs
+//creates a boolean plus function with random outputs, filled by the calling thread only
 fplus_t* fplus_create_random(unsigned variables, int max_value, unsigned non_zero_chance);
 fplus_t* fplus_create_random_wundefined(unsigned, int, unsigned); //like above but with don't care values
+//same as fplus_create_random, the same seed gives the same function, filled by the given threads (0 for all)
+fplus_t* fplus_create_random_wseed(unsigned variables, int max_value, unsigned non_zero_chance, uint64_t seed,
+                                   unsigned threads);
+//same as above with don't care values
+fplus_t* fplus_create_random_wundefined_wseed(unsigned, int, unsigned, uint64_t seed, unsigned threads);
+//creates a sparse boolean plus function storing only the given points
+fplus_t* fplus_create_sparse(const point_t* points, const int* values, size_t size, unsigned variables);
+//creates a sparse boolean plus function with the given number of random non zero points
+fplus_t* fplus_create_random_sparse(unsigned variables, int max_value, size_t size);
+fplus_t* fplus_create_random_sparse_wseed(unsigned, int, size_t, uint64_t seed); //same as above, the same seed gives the same function
 int fplus_value_of(fplus_t*, bool*); //returns the output of the function with the given input
-int fplus_value_at(fplus_t*, int); //returns the output of the function at the given index
+int fplus_value_at(fplus_t*, point_t); //returns the output of the function at the given index
+size_t fplus_size(fplus_t*); //returns the number of values stored
+long fplus_index_of(fplus_t*, point_t); //returns the position in values of the given point, -1 if not stored
+point_t fplus_point_at(fplus_t*, size_t); //returns the point whose value is in the given position
+
+//returns the output of the function at the given index, 0 for a don't care
+static inline unsigned fplus_weight_at(fplus_t* f, point_t index){
+    if(f -> sparse == NULL)
+        return fvalues_get(f -> values, index);
+    long i = fplus_index_of(f, index);
+    return i < 0 ? 0 : fvalues_get(f -> values, i);
+}
+
+//returns true if the point is a don't care
+static inline bool fplus_is_dont_care(fplus_t* f, point_t index){
+    if(f -> sparse == NULL)
+        return fvalues_is_dont_care(f -> values, index);
+    long i = fplus_index_of(f, index);
+    return i >= 0 && fvalues_is_dont_care(f -> values, i);
+}
 
 //add given value to the output of the function in the given input
-void fplus_add2value(fplus_t*, int index, int increment);
+void fplus_add2value(fplus_t*, point_t index, int increment);
 
 /*
  *  subtracts value to the output of the function in the given inputs.
  *  If a value reaches 0 or below is set to don't care
  */
-void fplus_sub2value_sopp(fplus_t* f, int index, int decrement);
+void fplus_sub2value_sopp(fplus_t* f, point_t index, int decrement);
 
 //same as above but when a value reaches 0 is not set to don't care
-void fplus_sub2value_dsopp(fplus_t* f, int index, int decrement);
+void fplus_sub2value_dsopp(fplus_t* f, point_t index, int decrement);
+//same as the two above on all the points covered by the cube
+void fplus_cube_sub_sopp(fplus_t*, cube_t, int decrement);
+void fplus_cube_sub_dsopp(fplus_t*, cube_t, int decrement);
+unsigned fplus_cube_max(fplus_t*, cube_t); //max output of the points covered by the cube
+//max output of the points covered by the cube, with the number and the smallest cube of the ones greater than 0
+unsigned fplus_cube_span(fplus_t*, cube_t, cube_t* span, size_t* positives);
+//min output greater than 0 of the points covered by the cube, sets zeros if a 0 (not don't care) is covered
+unsigned fplus_cube_min(fplus_t*, cube_t, bool* zeros);
+bool fplus_cube_dont_care(fplus_t*, cube_t); //true if all the points covered are don't cares
 void fplus_update_non_zeros(fplus_t*); //re-calculates the non_zeros array
 fplus_t* fplus_copy(fplus_t*); //returns a copy of f
 void fplus_copy_destroy(fplus_t*); //destroys a function created with fplus_copy
@@ -118,7 +224,7 @@ void fplus_destroy(fplus_t*); //frees the heap taken by the function
 /*
  * product plus related functions
  */
-productp_t* productp_create(bool*, unsigned variables, int coeff); //creates a product plus from given values
+productp_t* productp_create(cube_t, unsigned variables, int coeff); //creates a product plus from given cube
 productp_t* productp_copy(productp_t*); //generates a copy of the given product
 void productp_destroy(productp_t *p); //frees the memory of a product plus
 
@@ -126,17 +232,18 @@ void productp_destroy(productp_t *p); //frees the memory of a product plus
  * implicants related functions
  */
 implicants_t* prime_implicants(fplus_t*); //returns the prime implicants of the given bool plus function
+implicants_t* prime_implicants_wthreads(fplus_t*, unsigned threads); //same as above using more threads
 implicants_t* implicants_copy(implicants_t*); //returns a copy of the given implicants
 //merges the two implicants list and removes duplicates
 bool remove_implicant_duplicates(implicants_t *source, implicants_t *to_remove, fplus_t *f);
 void implicants_print(implicants_t*); //prints the list of implicants
-void implicants_soft_destroy(implicants_t* impl); //destroy implicants objects leaving values
 void implicants_destroy(implicants_t*); //frees the heap taken by the above function
 
 /*
  * essential related functions
  */
 essentialsp_t* essential_implicants(fplus_t*, implicants_t*); //returns the essential prime implicants
+essentialsp_t* essential_implicants_warena(fplus_t*, implicants_t*, arena_t*); //as above, scratch in the arena
 void essentials_print(essentialsp_t*, unsigned); //prints the implicants and the points
 void essentials_destroy(essentialsp_t*); //frees the heap taken by the above function
 
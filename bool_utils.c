@@ -2,7 +2,6 @@
 #include "utils.h"
 #include <stdlib.h>
 #include <string.h>
-#include <math.h>
 
 /**
  * Creates a boolean function given the output as values
@@ -37,8 +36,7 @@ bool f_get_value(bool_f* function, bool input[]){
 bool_product* product_create(bool product[], unsigned variables){
     bool_product* new_prod;
     MALLOC(new_prod, sizeof(bool_product), ;);
-    MALLOC(new_prod -> product, sizeof(bool) * variables, free(new_prod));
-    memcpy(new_prod -> product, product, sizeof(bool) * variables);
+    new_prod -> cube = cube_from_bvector(product, variables);
     new_prod -> variables = variables;
     return new_prod;
 }
@@ -47,49 +45,10 @@ bool_product* product_create(bool product[], unsigned variables){
  * @return the output of the product with the given variable values
  */
 bool product_of(bool_product* product, const bool input[]){
-    bool result = true;
-    int i = 0;
-    while(result && i < product -> variables){
-        switch(product -> product[i]){
-            case 0:
-                result = result && !input[i];
-                break;
-            case 1:
-                result = result && input[i];
-                break;
-            default:
-                break;
-        }
-        i++;
-    }
-    return result;
-}
-
-/**
- * @return true if b1[i] == b2[i] for each i
- */
-bool bvector_equals(const bool* b1, const bool* b2, unsigned variables){
-    if(!b1 || !b2)
-        return false;
-    for(int i = 0; i < variables; i++)
-        if(b1[i] != b2[i] && (b1[i] <= 1 || b2[i] <= 1))
-            return false;
-    return true;
-}
-
-/**
- * calculates the norm 1 of a boolean vector
- * @param b The vector
- * @param variables The size of the vector
- * @return The sum of the elements of the vector
- */
-int norm1(const bool* b, unsigned variables){
-    int sum = 0;
-    for(int i = 0; i < variables; i++){
-        if(b[i] <= 1)
-            sum += b[i];
-    }
-    return sum;
+    cword_t point = 0;
+    for(unsigned i = 0; i < product -> variables; i++)
+        point = (point << 1) | (input[i] & 1);
+    return cube_covers(product -> cube, point);
 }
 
 /**
@@ -100,67 +59,126 @@ int norm1(const bool* b, unsigned variables){
  */
 int binary2decimal(const bool *values, unsigned variables) {
     int number = 0;
-    for(int i = 0; i < variables; i++){
-        if(values[variables - i - 1] > 1) {
+    for(unsigned i = 0; i < variables; i++){
+        if(values[i] > 1) {
             return -1;
         }
-        number += values[variables - i - 1] * (int) exp2(i);
+        number = (number << 1) | values[i];
     }
     return number;
 }
 
 /**
- * Given a boolean vector with the special value '-' (ex: 0 0 1 -)
- * calculates the decimal values of all the possible vectors (ex: 0 0 1 0, 0 0 1 1)
- * @param values the boolean vector
- * @param variables length of the above vector
- * @param return_size size of the return array
- * @return an array with decimal values. Note: array will be in descending order
+ * Get the binary representation of the given number
  */
-int* binary2decimals(const bool *values, unsigned  variables, int* return_size){
-    //get final size of the array
-    *return_size = 1;
+bvector decimal2binary(point_t value, unsigned variables){
+    bool* binary;
+    MALLOC(binary, sizeof(bool) * variables, ;);
     for(int i = 0; i < variables; i++){
-        if(values[i] == dash || values[i] == not_present)
-            *return_size *= 2;
+        binary[variables - i - 1] = value & 1;
+        value >>= 1;
     }
+    return binary;
+}
 
-    int dash_found = 1;
+/**
+ * Packs a boolean vector in a cube
+ * @param b The vector, values different from true and false are considered free variables
+ * @param variables The size of the vector, at most CWORD_BITS
+ * @return The cube
+ */
+cube_t cube_from_bvector(const bool* b, unsigned variables){
+    cube_t c = {0, 0};
+    for(unsigned i = 0; i < variables; i++){
+        c.care <<= 1;
+        c.value <<= 1;
+        if(b[i] <= 1){
+            c.care |= 1;
+            c.value |= b[i];
+        }
+    }
+    return c;
+}
 
-    int* numbers;
-    MALLOC(numbers, sizeof(int) * *return_size,;); //will contain all the values
-    memset(numbers, 0, sizeof(int) * *return_size);
+/**
+ * @param index The point as decimal
+ * @param variables The number of variables of the point
+ * @return The cube covering only the given point
+ */
+cube_t cube_of_point(point_t index, unsigned variables){
+    cube_t c;
+    c.care = CUBE_MASK(variables);
+    c.value = index & c.care;
+    return c;
+}
 
-    //for each index of values, adds the power of 2 to each index of numbers
-    for(int i = 0; i < variables; i++){
+/**
+ * Unpacks a cube in a boolean vector
+ * @param c The cube
+ * @param variables The number of variables of the cube
+ * @param b Will contain the vector, free variables are set to not_present
+ */
+void cube_to_bvector(cube_t c, unsigned variables, bool* b){
+    for(unsigned i = 0; i < variables; i++){
+        cword_t bit = (cword_t) 1 << (variables - i - 1);
+        if(c.care & bit)
+            b[i] = (c.value & bit) != 0;
+        else
+            b[i] = not_present;
+    }
+}
 
-        //if dash then half the numbers have to be updated
-        if(values[variables - i - 1] == dash || values[variables - i - 1] == not_present){
-            for(int j = 0; j < *return_size; j += 2 * dash_found){
-                for(int k = 0; k < dash_found; k++){
-                    numbers[j + k] += (int) exp2(i);
-                }
-            }
+/**
+ * Calculates the decimal values of all the points covered by the cube
+ * (ex: 0 0 1 - covers 0 0 1 1 and 0 0 1 0)
+ * @param c The cube
+ * @param variables Number of variables of the cube
+ * @param return_size Size of the return array
+ * @return An array with decimal values. Note: array will be in descending order
+ */
+point_t* cube_points(cube_t c, unsigned variables, int* return_size){
+    cword_t free_vars = ~c.care & CUBE_MASK(variables);
+    *return_size = 1 << __builtin_popcountll(free_vars);
 
-            dash_found *= 2;
-        }else{
-            for(int j = 0; j < *return_size; j++){
-                numbers[j] += values[variables - i - 1] * (int) exp2(i);
-            }
-        }
-    }
+    point_t* numbers;
+    MALLOC(numbers, sizeof(point_t) * *return_size, ;);
+
+    //enumerates the subsets of the free variables, from the largest one
+    cword_t subset = free_vars;
+    int i = 0;
+    do{
+        numbers[i++] = c.value | subset;
+        subset = (subset - 1) & free_vars;
+    }while(subset != free_vars);
     return numbers;
 }
 
 /**
- * Get the binary representation of the given number
+ * Splits the points covered by the cube in runs of consecutive decimals, made by its free variables
+ * below the lowest literal. The runs start at c.value | s, for each subset s of the free variables returned
+ * (ex: 0 1 - - has one run of 4 points, - 1 0 - has two runs of 2 points)
+ * @param c The cube
+ * @param variables Number of variables of the cube
+ * @param run_size Will store the number of points of each run
+ * @return The free variables above the lowest literal
  */
-bvector decimal2binary(int value, unsigned variables){
-    bool* binary;
-    MALLOC(binary, sizeof(bool) * variables, ;);
-    for(int i = 0; i < variables; i++){
-        binary[variables - i - 1] = value % 2;
-        value /= 2;
+cword_t cube_runs(cube_t c, unsigned variables, size_t* run_size){
+    cword_t free_vars = ~c.care & CUBE_MASK(variables);
+    unsigned low = ~free_vars == 0 ? CWORD_BITS : (unsigned) __builtin_ctzll(~free_vars);
+    *run_size = low >= CWORD_BITS ? SIZE_MAX : (size_t) 1 << low;
+    return free_vars & ~CUBE_MASK(low);
+}
+
+/**
+ * Prints the cube as a sequence of 0, 1 and - (for free variables)
+ * @param separator The character to print after each variable
+ */
+void cube_print(cube_t c, unsigned variables, char separator){
+    for(unsigned i = 0; i < variables; i++){
+        cword_t bit = (cword_t) 1 << (variables - i - 1);
+        if(c.care & bit)
+            printf("%d%c", (c.value & bit) != 0, separator);
+        else
+            printf("-%c", separator);
     }
-    return binary;
 }
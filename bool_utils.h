@@ -5,6 +5,9 @@
 #ifndef DSOPP_SYNTHESIS_BOOL_UTILS_H
 #define DSOPP_SYNTHESIS_BOOL_UTILS_H
 
+#include <stddef.h>
+#include <stdint.h>
+
 #define false 0
 #define true 1
 #define not_present 2
@@ -14,13 +17,31 @@
 typedef unsigned char bool;
 typedef bool* bvector; //its value may assume the defined above (false, true, not_present, dash)
 
+typedef uint64_t cword_t; //machine word used to pack the variables of a cube
+#define CWORD_BITS 64 //bits in a cword_t, max number of variables of a cube_t and so of any function
+
+typedef cword_t point_t; //a point of the domain as decimal, the value of the cube covering only that point
+
+//mask with the lowest 'variables' bits set
+#define CUBE_MASK(variables) ((variables) >= CWORD_BITS ? ~(cword_t) 0 : ((cword_t) 1 << (variables)) - 1)
+
+/*
+ * A product of literals packed in a single word (up to CWORD_BITS variables).
+ * The variable i of a vector of n variables is stored in the bit n - i - 1, so that
+ * a cube with all the variables in care has as value the decimal of the point it covers
+ */
+typedef struct{
+    cword_t care; //bit set <=> the variable appears in the product
+    cword_t value; //bit set <=> the variable appears not negated, always a subset of care
+}cube_t;
+
 typedef struct{
     bvector values;
     unsigned int variables;
 }bool_f;
 
 typedef struct{
-    bvector product;
+    cube_t cube;
     unsigned variables;
 }bool_product;
 
@@ -31,19 +52,78 @@ typedef struct{
 
 //stores a list of implicants
 typedef struct {
-    bool** bvectors; //array of implicants
+    cube_t* cubes; //array of implicants
     int size; //size of above array
     unsigned variables;
 }implicants_t;
 
 /* Utility functions */
-int norm1(const bool*, unsigned variables); //returns the norm 1 of the vector
 int binary2decimal(const bool *values, unsigned variables); //returns the decimal of the given binary number
+bvector decimal2binary(point_t value, unsigned variables); //returns the binary representation of the given value
+
+/* Cube functions */
+cube_t cube_from_bvector(const bool*, unsigned variables); //packs a vector (with dashes) in a cube
+cube_t cube_of_point(point_t index, unsigned variables); //returns the cube covering only the given point
+void cube_to_bvector(cube_t, unsigned variables, bool* b); //unpacks a cube, free variables become not_present
+//returns the decimals of all the points covered by the cube, in descending order
+point_t* cube_points(cube_t, unsigned variables, int* return_size);
+//splits the points of the cube in runs of consecutive decimals, returns the free variables above the runs
+cword_t cube_runs(cube_t, unsigned variables, size_t* run_size);
+void cube_print(cube_t, unsigned variables, char separator); //prints the cube as a sequence of 0, 1 and -
 
-//same as above but it may return more decimal if values contains dashes
-int* binary2decimals(const bool *values, unsigned variables, int* return_size);
-bvector decimal2binary(int value, unsigned variables); //returns the binary representation of the given value
-bool bvector_equals(const bool* b1, const bool* b2, unsigned variables); //returns true if the 2 vector are the same one
+//returns the number of positive literals of the cube
+static inline int cube_norm1(cube_t c){
+    return __builtin_popcountll(c.value);
+}
+
+//returns the number of literals of the cube
+static inline int cube_literals(cube_t c){
+    return __builtin_popcountll(c.care);
+}
+
+//returns true if the two cubes are the same product
+static inline bool cube_equals(cube_t c1, cube_t c2){
+    return c1.care == c2.care && c1.value == c2.value;
+}
+
+//returns true if the point (as decimal) is covered by the cube
+static inline bool cube_covers(cube_t c, point_t point){
+    return ((point ^ c.value) & c.care) == 0;
+}
+
+//returns true if each point of small is also covered by big
+static inline bool cube_contains(cube_t big, cube_t small){
+    return (big.care & ~small.care) == 0 && ((big.value ^ small.value) & big.care) == 0;
+}
+
+//returns true if at least a point is covered by both cubes
+static inline bool cube_intersects(cube_t c1, cube_t c2){
+    return ((c1.value ^ c2.value) & c1.care & c2.care) == 0;
+}
+
+//returns an hashcode mixing all the bits of care and value (finalizer of murmur3)
+static inline size_t cube_hashcode(cube_t c){
+    uint64_t h = c.care * 0x9E3779B97F4A7C15ULL ^ c.value;
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDULL;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ULL;
+    h ^= h >> 33;
+    return (size_t) h;
+}
+
+/*
+ * Two cubes are joinable <=> they have the same literals and differ in exactly one of them.
+ * If they are, join is set as the cube without that literal
+ */
+static inline bool cube_join(cube_t c1, cube_t c2, cube_t* join){
+    cword_t diff = c1.value ^ c2.value;
+    if(c1.care != c2.care || diff == 0 || (diff & (diff - 1)) != 0)
+        return false;
+    join -> care = c1.care & ~diff;
+    join -> value = c1.value & ~diff;
+    return true;
+}
 
 /* Other functions */
 bool_f* f_create(bool[], int variables); //creates a boolean function given its output values
@@ -0,0 +1,46 @@
+#include "budget.h"
+
+/**
+ * Starts a budget
+ * @param budget The budget
+ * @param max_seconds Time from now to the deadline, 0 for no deadline
+ */
+void budget_init(budget_t* budget, double max_seconds){
+    budget -> over = false;
+    budget -> timed = max_seconds > 0;
+    clock_gettime(CLOCK_MONOTONIC, &budget -> deadline);
+    if(budget -> timed){
+        double end = (double) budget -> deadline.tv_sec + (double) budget -> deadline.tv_nsec / 1e9 + max_seconds;
+        budget -> deadline.tv_sec = (time_t) end;
+        budget -> deadline.tv_nsec = (long) ((end - (double) budget -> deadline.tv_sec) * 1e9);
+    }
+}
+
+/**
+ * Ends the budget, the syntheses using it stop at their next check
+ */
+void budget_cancel(budget_t* budget){
+    __atomic_store_n(&budget -> over, true, __ATOMIC_RELAXED);
+}
+
+/**
+ * Checks the budget, reading the clock if it has a deadline
+ * @param budget The budget, NULL for no limit
+ * @return true if the budget has been cancelled or the deadline passed
+ */
+bool budget_over(budget_t* budget){
+    if(budget == NULL)
+        return false;
+    if(__atomic_load_n(&budget -> over, __ATOMIC_RELAXED))
+        return true;
+    if(!budget -> timed)
+        return false;
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    if(now.tv_sec > budget -> deadline.tv_sec ||
+        (now.tv_sec == budget -> deadline.tv_sec && now.tv_nsec >= budget -> deadline.tv_nsec)){
+        budget_cancel(budget);
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,27 @@
+/*
+ * Library implementing the budget of a synthesis: a deadline and a cancellation flag, checked by the long
+ * loops of the syntheses taking one. When the budget is over the synthesis stops and completes the form found
+ * so far with a minterm for each point not yet reached, so that the form returned is still valid.
+ * A budget can be shared by many syntheses and cancelled from any thread
+ */
+
+#ifndef DSOPP_SYNTHESIS_BUDGET_H
+#define DSOPP_SYNTHESIS_BUDGET_H
+
+#include <time.h>
+#include "bool_utils.h"
+
+//iterations of an inner loop between two checks of the budget
+#define BUDGET_CHECK_STEPS 1024
+
+typedef struct{
+    bool over; //set when the budget is cancelled or the deadline passed, accessed atomically
+    bool timed; //true if there is a deadline
+    struct timespec deadline; //on the monotonic clock
+}budget_t;
+
+void budget_init(budget_t*, double max_seconds); //starts a budget of the given time, 0 for no deadline
+void budget_cancel(budget_t*); //ends the budget, from any thread
+bool budget_over(budget_t*); //true if the budget is cancelled or the deadline passed, false if NULL
+
+#endif //DSOPP_SYNTHESIS_BUDGET_H
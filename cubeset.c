@@ -0,0 +1,182 @@
+#include <string.h>
+#include "cubeset.h"
+#include "utils.h"
+
+//internal functions
+size_t* cubeset_slot(cubeset_t* set, cube_t c);
+bool cubeset_grow(cubeset_t* set);
+
+/**
+ * Creates an empty set of cubes
+ * @param expected_size The expected number of cubes, the set grows if exceeded
+ * @return A pointer to the set
+ */
+cubeset_t* cubeset_create(size_t expected_size){
+    cubeset_t* set;
+    MALLOC(set, sizeof(cubeset_t), ;);
+    set -> table_size = CUBESET_INIT_SIZE;
+    while(set -> table_size * CUBESET_LOAD < expected_size)
+        set -> table_size *= 2;
+    set -> max_length = (size_t) (set -> table_size * CUBESET_LOAD);
+    set -> length = 0;
+    MALLOC(set -> cubes, sizeof(cube_t) * set -> max_length, FREE(set));
+    MALLOC(set -> table, sizeof(size_t) * set -> table_size, FREE(set -> cubes); FREE(set));
+    memset(set -> table, 0, sizeof(size_t) * set -> table_size);
+    return set;
+}
+
+/**
+ * Creates a copy of the set, keeping the order of the elements
+ * @param set The set to copy
+ * @return A pointer to the new set
+ */
+cubeset_t* cubeset_copy(cubeset_t* set){
+    cubeset_t* copy;
+    MALLOC(copy, sizeof(cubeset_t), ;);
+    *copy = *set;
+    MALLOC(copy -> cubes, sizeof(cube_t) * set -> max_length, FREE(copy));
+    MALLOC(copy -> table, sizeof(size_t) * set -> table_size, FREE(copy -> cubes); FREE(copy));
+    memcpy(copy -> cubes, set -> cubes, sizeof(cube_t) * set -> length);
+    memcpy(copy -> table, set -> table, sizeof(size_t) * set -> table_size);
+    return copy;
+}
+
+/**
+ * @return The slot of the table containing the cube or the empty slot where it should be stored
+ */
+size_t* cubeset_slot(cubeset_t* set, cube_t c){
+    size_t mask = set -> table_size - 1;
+    size_t i = cube_hashcode(c) & mask;
+    while(set -> table[i] != 0 && !cube_equals(set -> cubes[set -> table[i] - 1], c))
+        i = (i + 1) & mask;
+    return set -> table + i;
+}
+
+/**
+ * Doubles the size of the table and of the array of elements, then rehashes all the elements
+ * @return The outcome of the operation
+ */
+bool cubeset_grow(cubeset_t* set){
+    size_t* new_table;
+    size_t new_size = set -> table_size * 2;
+    MALLOC(new_table, sizeof(size_t) * new_size, ;);
+    REALLOC(set -> cubes, sizeof(cube_t) * (size_t) (new_size * CUBESET_LOAD), FREE(new_table); return false);
+    memset(new_table, 0, sizeof(size_t) * new_size);
+    FREE(set -> table);
+    set -> table = new_table;
+    set -> table_size = new_size;
+    set -> max_length = (size_t) (new_size * CUBESET_LOAD);
+    for(size_t i = 0; i < set -> length; i++)
+        *cubeset_slot(set, set -> cubes[i]) = i + 1;
+    return true;
+}
+
+/**
+ * Adds the cube to the set if not already present
+ * @param set The set
+ * @param c The cube to add, it is copied
+ * @return true if the cube was added, false if already present or in case of error
+ */
+bool cubeset_add(cubeset_t* set, cube_t c){
+    size_t* slot = cubeset_slot(set, c);
+    if(*slot != 0)
+        return false;
+    if(set -> length == set -> max_length){
+        if(!cubeset_grow(set))
+            return false;
+        slot = cubeset_slot(set, c);
+    }
+    set -> cubes[set -> length++] = c;
+    *slot = set -> length;
+    return true;
+}
+
+/**
+ * Removes the cube from the set, the last element of the array takes its position
+ * @param set The set
+ * @param c The cube to remove
+ * @return true if the cube was in the set
+ */
+bool cubeset_remove(cubeset_t* set, cube_t c){
+    size_t* slot = cubeset_slot(set, c);
+    if(*slot == 0)
+        return false;
+    size_t position = *slot - 1;
+
+    //backward shift deletion: moves back the elements that would not be found after emptying the slot
+    size_t mask = set -> table_size - 1;
+    size_t empty = (size_t) (slot - set -> table);
+    size_t i = empty;
+    while(true){
+        i = (i + 1) & mask;
+        if(set -> table[i] == 0)
+            break;
+        size_t home = cube_hashcode(set -> cubes[set -> table[i] - 1]) & mask;
+        //moves the element if its home is not in the cyclic interval (empty, i]
+        if(((i - home) & mask) >= ((i - empty) & mask)){
+            set -> table[empty] = set -> table[i];
+            empty = i;
+        }
+    }
+    set -> table[empty] = 0;
+
+    //moves the last element in the position of the removed one
+    set -> length--;
+    if(position != set -> length){
+        set -> cubes[position] = set -> cubes[set -> length];
+        *cubeset_slot(set, set -> cubes[position]) = position + 1;
+    }
+    return true;
+}
+
+/**
+ * @return The position of the cube in the array of elements, -1 if not present
+ */
+long cubeset_index_of(cubeset_t* set, cube_t c){
+    return (long) *cubeset_slot(set, c) - 1;
+}
+
+/**
+ * @return true if the cube is in the set
+ */
+bool cubeset_contains(cubeset_t* set, cube_t c){
+    return *cubeset_slot(set, c) != 0;
+}
+
+/**
+ * @param size Will contain the number of elements
+ * @return The array of elements in order of insertion, valid until the next add
+ */
+cube_t* cubeset_as_array(cubeset_t* set, size_t* size){
+    if(size)
+        *size = set -> length;
+    return set -> cubes;
+}
+
+/**
+ * @return The number of elements in the set
+ */
+size_t cubeset_length(cubeset_t* set){
+    if(!set)
+        return 0;
+    return set -> length;
+}
+
+/**
+ * Removes all the elements from the set, the memory is kept for later use
+ */
+void cubeset_clear(cubeset_t* set){
+    memset(set -> table, 0, sizeof(size_t) * set -> table_size);
+    set -> length = 0;
+}
+
+/**
+ * Frees the memory used by the set
+ */
+void cubeset_destroy(cubeset_t* set){
+    if(set != NULL){
+        FREE(set -> cubes);
+        FREE(set -> table);
+        FREE(set);
+    }
+}
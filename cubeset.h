@@ -0,0 +1,35 @@
+/*
+ * Library implementing a hash set of cubes. The elements are kept in an array
+ * in order of insertion (a removal moves the last element in place of the removed one),
+ * the table uses open addressing with linear probing and grows to keep the load under CUBESET_LOAD
+ */
+
+#ifndef DSOPP_SYNTHESIS_CUBESET_H
+#define DSOPP_SYNTHESIS_CUBESET_H
+
+#include <stddef.h>
+#include "bool_utils.h"
+
+#define CUBESET_INIT_SIZE 16
+#define CUBESET_LOAD 0.5
+
+typedef struct{
+    cube_t* cubes; //the elements of the set
+    size_t length; //number of elements
+    size_t max_length; //size of the above array
+    size_t* table; //each slot stores the position + 1 of an element in cubes, 0 if empty
+    size_t table_size; //number of slots, always a power of 2
+}cubeset_t;
+
+cubeset_t* cubeset_create(size_t expected_size); //creates a set for the expected number of cubes
+cubeset_t* cubeset_copy(cubeset_t*); //returns a copy of the set
+bool cubeset_add(cubeset_t*, cube_t); //adds the cube, returns true if it was not already in the set
+bool cubeset_remove(cubeset_t*, cube_t); //removes the cube, returns true if it was in the set
+long cubeset_index_of(cubeset_t*, cube_t); //returns the position of the cube in the set, -1 if not present
+bool cubeset_contains(cubeset_t*, cube_t); //returns true if the cube is in the set
+cube_t* cubeset_as_array(cubeset_t*, size_t* size); //returns the elements in order of insertion
+size_t cubeset_length(cubeset_t*); //returns the number of elements
+void cubeset_clear(cubeset_t*); //removes all the elements keeping the memory
+void cubeset_destroy(cubeset_t*); //frees the memory used by the set
+
+#endif //DSOPP_SYNTHESIS_CUBESET_H
@@ -0,0 +1,395 @@
+#include <string.h>
+#include "espresso.h"
+#include "utils.h"
+
+#define ESPRESSO_INIT_SIZE 16
+#define WORD_VARIABLES 6 //variables indexing the bits of a word (64 = 2^6)
+
+//internal functions
+cword_t espresso_pattern(cube_t c);
+bool espresso_covers_zero(espresso_t* e, cube_t c);
+bool espresso_sparse_covers_zero(espresso_t* e, cube_t c);
+void espresso_count(espresso_t* e, cube_t c, int delta);
+bool espresso_needed(espresso_t* e, cube_t c, cube_t* reduced);
+bool espresso_append(espresso_t* e, cube_t c);
+cube_t espresso_expand_cube(espresso_t* e, cube_t c, unsigned offset);
+void espresso_expand(espresso_t* e, unsigned offset);
+void espresso_irredundant(espresso_t* e);
+void espresso_reduce(espresso_t* e);
+size_t espresso_literals(espresso_t* e);
+int cube_literals_compare(const void* c1, const void* c2);
+
+/**
+ * Creates an empty cover for the given function. If the function is dense the points with
+ * value 0 are stored in a bitmap, otherwise they are those not stored (or stored with value 0)
+ * @param f The function, it is not copied and must be valid until espresso_destroy
+ * @return A pointer to the structure
+ */
+espresso_t* espresso_create(fplus_t* f){
+    espresso_t* e;
+    size_t f_size = fplus_size(f);
+    MALLOC(e, sizeof(espresso_t), ;);
+    e -> f = f;
+    e -> words = f_size / CWORD_BITS + 1;
+    e -> size = 0;
+    e -> max_size = ESPRESSO_INIT_SIZE;
+    e -> off = NULL;
+    if(f -> sparse == NULL)
+        MALLOC(e -> off, sizeof(cword_t) * e -> words, FREE(e));
+    MALLOC(e -> on, sizeof(cword_t) * e -> words, FREE(e -> off); FREE(e));
+    MALLOC(e -> counts, sizeof(unsigned) * e -> words * CWORD_BITS, FREE(e -> on); FREE(e -> off); FREE(e));
+    MALLOC(e -> cubes, sizeof(cube_t) * e -> max_size, FREE(e -> counts); FREE(e -> on); FREE(e -> off); FREE(e));
+
+    memset(e -> counts, 0, sizeof(unsigned) * e -> words * CWORD_BITS);
+    if(e -> off != NULL)
+        fvalues_zeros(f -> values, f_size, e -> off);
+    return e;
+}
+
+/**
+ * Covers the points with value greater than lower. The current cover (valid for a lower
+ * threshold) is made irredundant, then each point still uncovered is expanded to a new cube.
+ * Finally reduce, expand and irredundant are repeated while the cover gets smaller.
+ * The points to cover must be a subset of those of the previous call, so that the counters
+ * of the cover are still valid for them
+ * @param e The cover
+ * @param lower The points with a value greater than this are covered
+ * @return The lowest value of the points covered, 0 if there are none (and the cover is empty)
+ */
+int espresso_minimize(espresso_t* e, int lower){
+    return espresso_minimize_wbudget(e, lower, NULL);
+}
+
+/**
+ * Same as espresso_minimize, the budget is checked every BUDGET_CHECK_STEPS points expanded and before
+ * each cycle: when it is over the points left are covered by minterms and the cycles are skipped,
+ * so that the cover is still valid
+ * @param e The cover
+ * @param lower The points with a value greater than this are covered
+ * @param budget The budget, NULL for no limit
+ * @return The lowest value of the points covered, 0 if there are none (and the cover is empty)
+ */
+int espresso_minimize_wbudget(espresso_t* e, int lower, budget_t* budget){
+    int lowest = (int) fvalues_above(e -> f -> values, fplus_size(e -> f), (unsigned) lower, e -> on);
+
+    espresso_irredundant(e);
+    size_t expanded = 0;
+    bool over = budget_over(budget);
+    for(size_t w = 0; w < e -> words; w++){
+        cword_t bits = e -> on[w];
+        while(bits){
+            size_t index = w * CWORD_BITS + __builtin_ctzll(bits);
+            bits &= bits - 1;
+            if(e -> counts[index] == 0){
+                cube_t c = cube_of_point(fplus_point_at(e -> f, index), e -> f -> variables);
+                espresso_count(e, c, 1);
+                if(!over && ++expanded % BUDGET_CHECK_STEPS == 0)
+                    over = budget_over(budget);
+                if(!espresso_append(e, over ? c : espresso_expand_cube(e, c, 0)))
+                    return 0;
+            }
+        }
+    }
+    if(over)
+        return lowest;
+    espresso_irredundant(e);
+
+    if(e -> size == 0)
+        return lowest;
+    cube_t* best;
+    MALLOC(best, sizeof(cube_t) * e -> size, ;);
+    for(unsigned i = 1; i <= ESPRESSO_MAX_ITERATIONS && !budget_over(budget); i++){
+        size_t best_size = e -> size;
+        size_t best_literals = espresso_literals(e);
+        memcpy(best, e -> cubes, sizeof(cube_t) * best_size);
+
+        espresso_reduce(e);
+        espresso_expand(e, i);
+        espresso_irredundant(e);
+
+        //keeps the previous cover if no improvement was found
+        if(e -> size > best_size || (e -> size == best_size && espresso_literals(e) >= best_literals)){
+            for(size_t j = 0; j < e -> size; j++)
+                espresso_count(e, e -> cubes[j], -1);
+            memcpy(e -> cubes, best, sizeof(cube_t) * best_size);
+            e -> size = best_size;
+            for(size_t j = 0; j < e -> size; j++)
+                espresso_count(e, e -> cubes[j], 1);
+            break;
+        }
+    }
+    FREE(best);
+    return lowest;
+}
+
+/**
+ * @param size Will contain the number of cubes
+ * @return The cubes of the current cover, valid until the next espresso_minimize
+ */
+cube_t* espresso_cover(espresso_t* e, size_t* size){
+    if(size)
+        *size = e -> size;
+    return e -> cubes;
+}
+
+/**
+ * Returns the bits of a word covered by the cube, considering only the lowest
+ * WORD_VARIABLES variables (those indexing the bits of the word)
+ */
+cword_t espresso_pattern(cube_t c){
+    //for each of the lowest variables, the bits of the word where it is 1
+    static const cword_t ones[WORD_VARIABLES] = {
+            0xAAAAAAAAAAAAAAAAULL, 0xCCCCCCCCCCCCCCCCULL, 0xF0F0F0F0F0F0F0F0ULL,
+            0xFF00FF00FF00FF00ULL, 0xFFFF0000FFFF0000ULL, 0xFFFFFFFF00000000ULL
+    };
+    cword_t pattern = ~(cword_t) 0;
+    for(unsigned b = 0; b < WORD_VARIABLES; b++)
+        if(c.care & ((cword_t) 1 << b))
+            pattern &= c.value & ((cword_t) 1 << b) ? ones[b] : ~ones[b];
+    return pattern;
+}
+
+/**
+ * @return true if at least a point covered by the cube has value 0
+ */
+bool espresso_covers_zero(espresso_t* e, cube_t c){
+    if(e -> off == NULL)
+        return espresso_sparse_covers_zero(e, c);
+    unsigned variables = e -> f -> variables;
+    cword_t pattern = espresso_pattern(c);
+    cword_t free_words = ~(c.care >> WORD_VARIABLES) &
+            CUBE_MASK(variables > WORD_VARIABLES ? variables - WORD_VARIABLES : 0);
+    cword_t value_words = c.value >> WORD_VARIABLES;
+    //enumerates the words covered as submasks of the free variables
+    cword_t s = 0;
+    do{
+        if(e -> off[value_words | s] & pattern)
+            return true;
+        s = (s - free_words) & free_words;
+    }while(s != 0);
+    return false;
+}
+
+/**
+ * Same as above for sparse functions, the points covered are looked up one at a time
+ */
+bool espresso_sparse_covers_zero(espresso_t* e, cube_t c){
+    cword_t free_vars = ~c.care & CUBE_MASK(e -> f -> variables);
+    int free_count = __builtin_popcountll(free_vars);
+    if(free_count >= CWORD_BITS - 1 || (size_t) 1 << free_count > fplus_size(e -> f))
+        return true; //covers more points than those stored
+    cword_t s = 0;
+    do{
+        long index = fplus_index_of(e -> f, c.value | s);
+        if(index < 0 || (fvalues_get(e -> f -> values, index) == 0 &&
+            !fvalues_is_dont_care(e -> f -> values, index)))
+            return true;
+        s = (s - free_vars) & free_vars;
+    }while(s != 0);
+    return false;
+}
+
+/**
+ * Adds delta to the counter of each point of the layer covered by the cube
+ */
+void espresso_count(espresso_t* e, cube_t c, int delta){
+    unsigned variables = e -> f -> variables;
+    if(e -> f -> sparse != NULL){
+        cword_t free_vars = ~c.care & CUBE_MASK(variables);
+        cword_t s = 0;
+        do{
+            long index = fplus_index_of(e -> f, c.value | s);
+            if(index >= 0 && e -> on[index / CWORD_BITS] & (cword_t) 1 << (index % CWORD_BITS))
+                e -> counts[index] += delta;
+            s = (s - free_vars) & free_vars;
+        }while(s != 0);
+        return;
+    }
+    cword_t pattern = espresso_pattern(c);
+    cword_t free_words = ~(c.care >> WORD_VARIABLES) &
+            CUBE_MASK(variables > WORD_VARIABLES ? variables - WORD_VARIABLES : 0);
+    cword_t value_words = c.value >> WORD_VARIABLES;
+    cword_t s = 0;
+    do{
+        size_t w = value_words | s;
+        cword_t bits = e -> on[w] & pattern;
+        while(bits){
+            e -> counts[w * CWORD_BITS + __builtin_ctzll(bits)] += delta;
+            bits &= bits - 1;
+        }
+        s = (s - free_words) & free_words;
+    }while(s != 0);
+}
+
+/**
+ * Checks if the cube is the only one covering some points of the layer
+ * @param e The cover, with the counters up to date
+ * @param c The cube
+ * @param reduced If not NULL, will contain the smallest cube covering all those points
+ * @return true if there is at least a point covered only by the given cube
+ */
+bool espresso_needed(espresso_t* e, cube_t c, cube_t* reduced){
+    unsigned variables = e -> f -> variables;
+    cword_t pattern = espresso_pattern(c);
+    cword_t free_words = ~(c.care >> WORD_VARIABLES) &
+            CUBE_MASK(variables > WORD_VARIABLES ? variables - WORD_VARIABLES : 0);
+    cword_t value_words = c.value >> WORD_VARIABLES;
+    cword_t all_and = ~(cword_t) 0, all_or = 0; //and, or of the points found
+    bool found = false;
+    cword_t s = 0;
+    if(e -> f -> sparse != NULL){
+        cword_t free_vars = ~c.care & CUBE_MASK(variables);
+        do{
+            point_t point = c.value | s;
+            long index = fplus_index_of(e -> f, point);
+            if(index >= 0 && e -> on[index / CWORD_BITS] & (cword_t) 1 << (index % CWORD_BITS) &&
+                e -> counts[index] == 1){
+                if(reduced == NULL)
+                    return true;
+                found = true;
+                all_and &= point;
+                all_or |= point;
+            }
+            s = (s - free_vars) & free_vars;
+        }while(s != 0);
+    } else {
+        do{
+            size_t w = value_words | s;
+            cword_t bits = e -> on[w] & pattern;
+            while(bits){
+                size_t point = w * CWORD_BITS + __builtin_ctzll(bits);
+                bits &= bits - 1;
+                if(e -> counts[point] == 1){
+                    if(reduced == NULL)
+                        return true;
+                    found = true;
+                    all_and &= point;
+                    all_or |= point;
+                }
+            }
+            s = (s - free_words) & free_words;
+        }while(s != 0);
+    }
+
+    if(found){
+        //the variables in care are those with the same value in all the points
+        reduced -> care = ~(all_and ^ all_or) & CUBE_MASK(variables);
+        reduced -> value = all_and & reduced -> care;
+    }
+    return found;
+}
+
+/**
+ * Adds a cube to the cover, the counters are not updated
+ * @return The outcome of the operation
+ */
+bool espresso_append(espresso_t* e, cube_t c){
+    if(e -> size == e -> max_size){
+        e -> max_size *= 2;
+        REALLOC(e -> cubes, sizeof(cube_t) * e -> max_size, return false);
+    }
+    e -> cubes[e -> size++] = c;
+    return true;
+}
+
+/**
+ * Removes the literals of the cube, one at a time, while no point with value 0 is covered.
+ * A literal that can not be removed will never be, since the cube only grows.
+ * The counters are updated with the points added to the cube
+ * @param e The cover
+ * @param c The cube to expand
+ * @param offset The variable from which to start, used to find a different expansion
+ * @return The expanded cube
+ */
+cube_t espresso_expand_cube(espresso_t* e, cube_t c, unsigned offset){
+    unsigned variables = e -> f -> variables;
+    for(unsigned i = 0; i < variables; i++){
+        cword_t literal = (cword_t) 1 << ((i + offset) % variables);
+        if(!(c.care & literal))
+            continue;
+        //the half added by removing the literal
+        cube_t half = {c.care, c.value ^ literal};
+        if(!espresso_covers_zero(e, half)){
+            espresso_count(e, half, 1);
+            c.care &= ~literal;
+            c.value &= ~literal;
+        }
+    }
+    return c;
+}
+
+/**
+ * Expands each cube of the cover
+ */
+void espresso_expand(espresso_t* e, unsigned offset){
+    for(size_t i = 0; i < e -> size; i++)
+        e -> cubes[i] = espresso_expand_cube(e, e -> cubes[i], offset);
+}
+
+/**
+ * Removes the cubes whose points are all covered by others, starting from the smallest cubes
+ */
+void espresso_irredundant(espresso_t* e){
+    qsort(e -> cubes, e -> size, sizeof(cube_t), cube_literals_compare);
+
+    size_t kept = 0;
+    for(size_t i = 0; i < e -> size; i++){
+        if(espresso_needed(e, e -> cubes[i], NULL))
+            e -> cubes[kept++] = e -> cubes[i];
+        else
+            espresso_count(e, e -> cubes[i], -1);
+    }
+    e -> size = kept;
+}
+
+/**
+ * Replaces each cube of the cover with the smallest cube covering the points
+ * covered only by it, starting from the biggest cubes
+ */
+void espresso_reduce(espresso_t* e){
+    size_t kept = 0;
+    for(size_t i = e -> size; i-- > 0;){
+        cube_t reduced;
+        bool needed = espresso_needed(e, e -> cubes[i], &reduced);
+        espresso_count(e, e -> cubes[i], -1);
+        if(needed){
+            espresso_count(e, reduced, 1);
+            e -> cubes[i] = reduced;
+        } else
+            e -> cubes[i] = (cube_t) {0, ~(cword_t) 0}; //marked as removed, not a valid cube
+    }
+    for(size_t i = 0; i < e -> size; i++)
+        if((e -> cubes[i].value & ~e -> cubes[i].care) == 0)
+            e -> cubes[kept++] = e -> cubes[i];
+    e -> size = kept;
+}
+
+/**
+ * @return The number of literals in the cover
+ */
+size_t espresso_literals(espresso_t* e){
+    size_t literals = 0;
+    for(size_t i = 0; i < e -> size; i++)
+        literals += cube_literals(e -> cubes[i]);
+    return literals;
+}
+
+/**
+ * Compares the cubes by number of literals, the cube with more literals (smaller) comes first
+ */
+int cube_literals_compare(const void* c1, const void* c2){
+    return cube_literals(*(const cube_t*) c2) - cube_literals(*(const cube_t*) c1);
+}
+
+/**
+ * Frees the memory used, the function is not destroyed
+ */
+void espresso_destroy(espresso_t* e){
+    if(e != NULL){
+        FREE(e -> off);
+        FREE(e -> on);
+        FREE(e -> counts);
+        FREE(e -> cubes);
+        FREE(e);
+    }
+}
@@ -0,0 +1,36 @@
+/*
+ * Library implementing an Espresso-like heuristic minimization of a cover of cubes.
+ * The function is split in layers: each layer has as points to cover those with value above a threshold,
+ * while the points with value 0 can never be covered. Each layer is covered starting from the cover
+ * of the previous one, then expand, irredundant and reduce are repeated while the cover improves.
+ * Prime implicants are never enumerated, the points are checked on bitmaps with a word per 64 points
+ * (for sparse functions the points covered are looked up one at a time)
+ */
+
+#ifndef DSOPP_SYNTHESIS_ESPRESSO_H
+#define DSOPP_SYNTHESIS_ESPRESSO_H
+
+#include "bool_plus.h"
+
+//max number of reduce, expand, irredundant cycles done for each layer
+#define ESPRESSO_MAX_ITERATIONS 8
+
+typedef struct{
+    fplus_t* f; //the function, only read
+    size_t words; //size of the bitmaps, each bit stands for a position of f -> values
+    cword_t* off; //bitmap of the points with value 0, NULL if the function is sparse
+    cword_t* on; //bitmap of the points to cover in the current layer
+    unsigned* counts; //number of cubes of the cover covering each point of the layer, always up to date
+    cube_t* cubes; //the current cover
+    size_t size; //number of cubes in the cover
+    size_t max_size; //size of the above array
+}espresso_t;
+
+espresso_t* espresso_create(fplus_t*); //creates an empty cover for the given function
+//minimizes the cover of the points with value > lower starting from the current cover, returns their lowest value
+int espresso_minimize(espresso_t*, int lower);
+int espresso_minimize_wbudget(espresso_t*, int lower, budget_t*); //same as above, stops early when the budget is over
+cube_t* espresso_cover(espresso_t*, size_t* size); //returns the current cover
+void espresso_destroy(espresso_t*); //frees the memory used
+
+#endif //DSOPP_SYNTHESIS_ESPRESSO_H
@@ -0,0 +1,816 @@
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "exact.h"
+#include "utils.h"
+
+//a subtree of the search, given by the coefficients and the forbidden primes at its root
+typedef struct{
+    int* coeff;
+    uint8_t* forbidden;
+    long weight; //sum of coeff
+}exact_task_t;
+
+//state of a search, shared by the workers
+typedef struct{
+    exact_t* e;
+    exact_task_t* tasks; //stack of subtrees not yet visited
+    size_t tasks_size; //number of subtrees in the stack
+    size_t tasks_max; //size of above array
+    unsigned workers; //number of workers
+    unsigned idle; //workers waiting for a subtree
+    bool done; //true when all the workers are idle and the stack is empty
+    bool stop; //true when a limit is reached
+    size_t max_nodes; //0 for no limit
+    size_t nodes; //nodes visited by all the workers, updated every EXACT_CHECK_NODES
+    budget_t timer; //the time of the search
+    budget_t* budget; //the budget of the caller, NULL for none
+    pthread_mutex_t lock; //protects the stack, idle, done and the best form
+    pthread_cond_t cond; //signaled when a subtree is added or the search is done
+}exact_work_t;
+
+//a slot of the table of the states visited by a worker
+typedef struct{
+    uint64_t hash; //hash of the state
+    size_t state; //position + 1 of the state in the states of the worker, 0 for an empty slot
+}exact_slot_t;
+
+//state of a worker, changed and restored while visiting a subtree
+typedef struct{
+    exact_work_t* work;
+    int* coeff; //coefficient of each prime
+    uint8_t* forbidden; //1 if the prime cannot be increased in the subtree
+    long* covered; //sum of the coefficients of the primes covering each point
+    size_t* trail; //primes forbidden in the current path, to allow them again when going back
+    size_t trail_size;
+    size_t* stamp; //used by the lower bound to mark the primes
+    size_t stamp_now;
+    uint64_t hash_coeff; //sum of the coefficients multiplied by the keys of their primes
+    uint64_t hash_forbidden; //xor of the keys of the primes forbidden
+    exact_slot_t* memo; //the states visited, a slot keeps the first state stored in it
+    uint8_t* states; //the states of the slots, each one is its coefficients followed by its forbidden flags
+    size_t states_size; //bytes used in above array
+    size_t states_max; //size of above array, at most EXACT_MEMO_BYTES
+    size_t nodes; //nodes visited since the last check of the limits
+}exact_worker_t;
+
+//internal functions
+implicants_t* exact_prime_implicants(fplus_t* f);
+bool exact_primes(exact_t* e, implicants_t* implicants);
+int exact_point_compare(const void* a, const void* b);
+int exact_prime_compare(const void* a, const void* b);
+uint64_t exact_key(uint64_t seed);
+void* exact_worker(void* arg);
+void exact_load(exact_worker_t* w, exact_task_t* task);
+void exact_visit(exact_worker_t* w, long weight);
+bool exact_visited(exact_worker_t* w);
+void exact_increase(exact_worker_t* w, size_t prime, int amount);
+void exact_forbid(exact_worker_t* w, size_t prime);
+long exact_bound(exact_worker_t* w);
+bool exact_stopped(exact_worker_t* w);
+void exact_check_limits(exact_worker_t* w);
+bool exact_donate(exact_worker_t* w, long weight, size_t point, size_t from);
+void exact_solution(exact_worker_t* w, long weight);
+
+//a point to cover, sorted by value
+typedef struct{
+    long position; //position of the point in the values of f
+    unsigned value;
+}exact_point_t;
+
+//a prime with the points it covers, sorted by their number
+typedef struct{
+    cube_t cube;
+    size_t start; //row of the prime in the bitmaps of the points covered
+    size_t size; //number of points covered
+}exact_prime_t;
+
+/**
+ * Prepares the search: finds the prime implicants, removes the dominated ones and builds
+ * the lists of points covered by each prime and of the primes covering each point.
+ * The lightest of the forms found by sopp_synthesis and sopp_synthesis_heuristic is the first best form
+ * @param f The function, it must not be changed while the search is used
+ * @param budget The budget of the greedy and heuristic syntheses, NULL for no limit
+ * @return A pointer to the search
+ */
+exact_t* exact_create(fplus_t* f, budget_t* budget){
+    exact_t* e;
+    MALLOC(e, sizeof(exact_t), ;);
+    memset(e, 0, sizeof(exact_t));
+    e -> f = f;
+
+    sopp_t* greedy = sopp_synthesis_wbudget(f, budget);
+    sopp_t* heuristic = sopp_synthesis_heuristic_wbudget(f, budget);
+    if(greedy == NULL || heuristic == NULL){
+        sopp_destroy(greedy);
+        sopp_destroy(heuristic);
+        exact_destroy(e);
+        return NULL;
+    }
+    if(sopp_weights_sum(heuristic) < sopp_weights_sum(greedy)){
+        e -> initial = heuristic;
+        sopp_destroy(greedy);
+    } else {
+        e -> initial = greedy;
+        sopp_destroy(heuristic);
+    }
+    e -> best_weight = sopp_weights_sum(e -> initial);
+
+    implicants_t* implicants = exact_prime_implicants(f);
+    if(implicants == NULL || !exact_primes(e, implicants)){
+        if(implicants != NULL)
+            implicants_destroy(implicants);
+        exact_destroy(e);
+        return NULL;
+    }
+    implicants_destroy(implicants);
+    return e;
+}
+
+/**
+ * Finds all the cubes covering no point with value 0 and at least a point with value greater than 0,
+ * that are not contained in another such cube. For a dense function with up to EXACT_PRIMES_VARIABLES
+ * variables each cube is checked from the two with a free variable less (a ternary digit for each variable:
+ * 0, 1 or free), else the implicants of prime_implicants are returned
+ * @return The prime implicants
+ */
+implicants_t* exact_prime_implicants(fplus_t* f){
+    if(f -> sparse != NULL || f -> variables > EXACT_PRIMES_VARIABLES)
+        return prime_implicants(f);
+    unsigned n = f -> variables;
+    size_t size = 1;
+    for(unsigned i = 0; i < n; i++)
+        size *= 3;
+    //bit 0: no point with value 0 is covered, bit 1: a point with value greater than 0 is covered
+    uint8_t* flags;
+    size_t* power;
+    MALLOC(flags, size, ;);
+    MALLOC(power, sizeof(size_t) * (n + 1), FREE(flags));
+    power[0] = 1;
+    for(unsigned i = 0; i < n; i++)
+        power[i + 1] = power[i] * 3;
+
+    size_t primes_size = 0;
+    for(size_t t = 0; t < size; t++){
+        //digit j is the variable with bit j in the points
+        size_t rest = t;
+        unsigned free_digit = n;
+        point_t point = 0;
+        for(unsigned j = 0; j < n; j++, rest /= 3){
+            if(rest % 3 == 2 && free_digit == n)
+                free_digit = j;
+            point |= (point_t) (rest % 3 == 1) << j;
+        }
+        if(free_digit < n){
+            uint8_t zero = flags[t - 2 * power[free_digit]], one = flags[t - power[free_digit]];
+            flags[t] = (uint8_t) ((zero & one & 1) | ((zero | one) & 2));
+        } else {
+            bool is_dont_care = fvalues_is_dont_care(f -> values, point);
+            unsigned value = fvalues_get(f -> values, point);
+            flags[t] = (uint8_t) ((is_dont_care || value > 0) | (!is_dont_care && value > 0) << 1);
+        }
+    }
+
+    implicants_t* primes;
+    MALLOC(primes, sizeof(implicants_t), FREE(flags); FREE(power));
+    primes -> variables = n;
+    primes -> size = 0;
+    MALLOC(primes -> cubes, sizeof(cube_t) * INIT_SIZE, FREE(flags); FREE(power); FREE(primes));
+    size_t primes_max = INIT_SIZE;
+    for(size_t t = 0; t < size; t++){
+        if(flags[t] != 3)
+            continue;
+        bool prime = true;
+        cube_t c = {0, 0};
+        size_t rest = t;
+        for(unsigned j = 0; j < n; j++, rest /= 3){
+            size_t digit = rest % 3;
+            if(digit == 2)
+                continue;
+            c.care |= (cword_t) 1 << j;
+            c.value |= (cword_t) digit << j;
+            //the cube with the variable free
+            prime = prime && (flags[t + (2 - digit) * power[j]] & 1) == 0;
+        }
+        if(!prime)
+            continue;
+        if(primes_size == primes_max){
+            primes_max *= 2;
+            REALLOC(primes -> cubes, sizeof(cube_t) * primes_max, FREE(flags); FREE(power); return NULL);
+        }
+        primes -> cubes[primes_size++] = c;
+    }
+    primes -> size = (int) primes_size;
+    FREE(flags);
+    FREE(power);
+    return primes;
+}
+
+/**
+ * Sets the points to cover (the ones not don't care with value greater than 0) and the primes not dominated,
+ * a prime is dominated if another prime covers all its points (for equal primes the first one is kept)
+ * @return The outcome of the operation
+ */
+bool exact_primes(exact_t* e, implicants_t* implicants){
+    fplus_t* f = e -> f;
+    size_t f_size = fplus_size(f);
+    exact_point_t* points;
+    long* point_of; //for each position of the values of f, its point or -1
+    MALLOC(points, sizeof(exact_point_t) * (f_size > 0 ? f_size : 1), ;);
+    MALLOC(point_of, sizeof(long) * (f_size > 0 ? f_size : 1), FREE(points));
+    size_t m = 0;
+    for(size_t i = 0; i < f_size; i++){
+        unsigned value = fvalues_get(f -> values, i);
+        if(value > 0 && !fvalues_is_dont_care(f -> values, i)){
+            points[m].position = (long) i;
+            points[m++].value = value;
+        }
+    }
+    qsort(points, m, sizeof(exact_point_t), exact_point_compare);
+    for(size_t i = 0; i < f_size; i++)
+        point_of[i] = -1;
+    MALLOC(e -> demand, sizeof(unsigned) * (m > 0 ? m : 1), FREE(points); FREE(point_of));
+    for(size_t x = 0; x < m; x++){
+        point_of[points[x].position] = (long) x;
+        e -> demand[x] = points[x].value;
+    }
+    e -> points_size = m;
+    FREE(points);
+
+    //points covered by each prime, as bitmaps to find the dominated ones
+    size_t n = (size_t) implicants -> size;
+    size_t words = m / CWORD_BITS + 1;
+    cword_t* bits;
+    exact_prime_t* primes;
+    MALLOC(bits, sizeof(cword_t) * words * (n > 0 ? n : 1), FREE(point_of));
+    MALLOC(primes, sizeof(exact_prime_t) * (n > 0 ? n : 1), FREE(point_of); FREE(bits));
+    memset(bits, 0, sizeof(cword_t) * words * n);
+    for(size_t p = 0; p < n; p++){
+        cube_t c = implicants -> cubes[p];
+        cword_t* row = bits + p * words;
+        cword_t free_vars = ~c.care & CUBE_MASK(f -> variables);
+        unsigned free_count = (unsigned) __builtin_popcountll(free_vars);
+        if(f -> sparse == NULL || (free_count < CWORD_BITS && ((size_t) 1 << free_count) <= f_size)){
+            cword_t subset = free_vars;
+            do{
+                long index = fplus_index_of(f, c.value | subset);
+                if(index >= 0 && point_of[index] >= 0)
+                    row[point_of[index] / CWORD_BITS] |= (cword_t) 1 << (point_of[index] % CWORD_BITS);
+                subset = (subset - 1) & free_vars;
+            }while(subset != free_vars);
+        } else {
+            for(size_t i = 0; i < f_size; i++)
+                if(point_of[i] >= 0 && cube_covers(c, fplus_point_at(f, i)))
+                    row[point_of[i] / CWORD_BITS] |= (cword_t) 1 << (point_of[i] % CWORD_BITS);
+        }
+        primes[p].cube = c;
+        primes[p].start = p;
+        primes[p].size = 0;
+        for(size_t w = 0; w < words; w++)
+            primes[p].size += (size_t) __builtin_popcountll(row[w]);
+    }
+    FREE(point_of);
+
+    bool* dominated;
+    MALLOC(dominated, sizeof(bool) * (n > 0 ? n : 1), FREE(bits); FREE(primes));
+    for(size_t p = 0; p < n; p++){
+        dominated[p] = primes[p].size == 0;
+        for(size_t q = 0; q < n && !dominated[p]; q++){
+            if(q == p || primes[q].size < primes[p].size || (primes[q].size == primes[p].size && q > p))
+                continue;
+            bool contained = true;
+            for(size_t w = 0; w < words && contained; w++)
+                contained = (bits[p * words + w] & ~bits[q * words + w]) == 0;
+            dominated[p] = contained;
+        }
+    }
+    size_t kept = 0;
+    for(size_t p = 0; p < n; p++)
+        if(!dominated[p])
+            primes[kept++] = primes[p];
+    FREE(dominated);
+    qsort(primes, kept, sizeof(exact_prime_t), exact_prime_compare);
+
+    //lists of the points covered by each prime, then of the primes covering each point
+    size_t total = 0;
+    for(size_t p = 0; p < kept; p++)
+        total += primes[p].size;
+    e -> primes_size = kept;
+    MALLOC(e -> primes, sizeof(cube_t) * (kept > 0 ? kept : 1), FREE(bits); FREE(primes));
+    MALLOC(e -> covers_start, sizeof(size_t) * (kept + 1), FREE(bits); FREE(primes));
+    MALLOC(e -> covers, sizeof(size_t) * (total > 0 ? total : 1), FREE(bits); FREE(primes));
+    MALLOC(e -> coverers_start, sizeof(size_t) * (m + 1), FREE(bits); FREE(primes));
+    MALLOC(e -> coverers, sizeof(size_t) * (total > 0 ? total : 1), FREE(bits); FREE(primes));
+    memset(e -> coverers_start, 0, sizeof(size_t) * (m + 1));
+    size_t k = 0;
+    for(size_t p = 0; p < kept; p++){
+        e -> primes[p] = primes[p].cube;
+        e -> covers_start[p] = k;
+        cword_t* row = bits + primes[p].start * words;
+        for(size_t w = 0; w < words; w++)
+            for(cword_t b = row[w]; b != 0; b &= b - 1){
+                size_t x = w * CWORD_BITS + __builtin_ctzll(b);
+                e -> covers[k++] = x;
+                e -> coverers_start[x + 1]++;
+            }
+    }
+    e -> covers_start[kept] = k;
+    for(size_t x = 0; x < m; x++)
+        e -> coverers_start[x + 1] += e -> coverers_start[x];
+    //fills the lists of the points moving their start forward, then shifts the starts back
+    for(size_t p = 0; p < kept; p++)
+        for(size_t i = e -> covers_start[p]; i < e -> covers_start[p + 1]; i++)
+            e -> coverers[e -> coverers_start[e -> covers[i]]++] = p;
+    for(size_t x = m; x > 0; x--)
+        e -> coverers_start[x] = e -> coverers_start[x - 1];
+    e -> coverers_start[0] = 0;
+    FREE(bits);
+    FREE(primes);
+
+    MALLOC(e -> keys, sizeof(uint64_t) * 2 * (kept > 0 ? kept : 1), ;);
+    for(size_t p = 0; p < 2 * kept; p++)
+        e -> keys[p] = exact_key(p);
+    return true;
+}
+
+/**
+ * Orders the points by descending value, so that the lower bound picks the highest ones first
+ */
+int exact_point_compare(const void* a, const void* b){
+    const exact_point_t* x = a;
+    const exact_point_t* y = b;
+    if(x -> value != y -> value)
+        return x -> value > y -> value ? -1 : 1;
+    return x -> position < y -> position ? -1 : x -> position > y -> position;
+}
+
+/**
+ * Orders the primes by descending number of points covered, so that the first branches are the greedy ones
+ */
+int exact_prime_compare(const void* a, const void* b){
+    const exact_prime_t* p = a;
+    const exact_prime_t* q = b;
+    if(p -> size != q -> size)
+        return p -> size > q -> size ? -1 : 1;
+    return p -> start < q -> start ? -1 : p -> start > q -> start;
+}
+
+/**
+ * @return A random looking key for the given seed (splitmix64)
+ */
+uint64_t exact_key(uint64_t seed){
+    uint64_t z = (seed + 1) * 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+/**
+ * Searches the form with minimum weight, starting from the best form already found
+ * @param e The search
+ * @param threads The number of workers, 0 to use one for each processor online
+ * @param max_nodes Max number of nodes visited, 0 for no limit
+ * @param max_seconds Max time of the search, 0 for no limit
+ * @param budget The budget of the caller, checked with the other limits, NULL for no limit
+ * @return true if the best form has been proved minimal, false if a limit was reached (or in case of error)
+ */
+bool exact_search(exact_t* e, unsigned threads, size_t max_nodes, double max_seconds, budget_t* budget){
+    if(threads == 0){
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = online > 0 ? (unsigned) online : 1;
+    }
+    size_t p_size = e -> primes_size > 0 ? e -> primes_size : 1;
+    size_t m_size = e -> points_size > 0 ? e -> points_size : 1;
+
+    exact_work_t work;
+    memset(&work, 0, sizeof(exact_work_t));
+    work.e = e;
+    work.workers = threads;
+    work.max_nodes = max_nodes;
+    budget_init(&work.timer, max_seconds);
+    work.budget = budget;
+    work.tasks_max = threads * 4;
+    MALLOC(work.tasks, sizeof(exact_task_t) * work.tasks_max, ;);
+    //the root of the search
+    MALLOC(work.tasks[0].coeff, sizeof(int) * p_size, FREE(work.tasks));
+    MALLOC(work.tasks[0].forbidden, sizeof(uint8_t) * p_size, FREE(work.tasks[0].coeff); FREE(work.tasks));
+    memset(work.tasks[0].coeff, 0, sizeof(int) * p_size);
+    memset(work.tasks[0].forbidden, 0, sizeof(uint8_t) * p_size);
+    work.tasks[0].weight = 0;
+    work.tasks_size = 1;
+    pthread_mutex_init(&work.lock, NULL);
+    pthread_cond_init(&work.cond, NULL);
+
+    exact_worker_t* workers;
+    pthread_t* ids;
+    MALLOC(workers, sizeof(exact_worker_t) * threads, ;);
+    MALLOC(ids, sizeof(pthread_t) * threads, FREE(workers));
+    unsigned ready = 0;
+    bool failed = false;
+    for(; ready < threads && !failed; ready++){
+        exact_worker_t* w = workers + ready;
+        memset(w, 0, sizeof(exact_worker_t));
+        w -> work = &work;
+        w -> coeff = malloc(sizeof(int) * p_size);
+        w -> forbidden = malloc(sizeof(uint8_t) * p_size);
+        w -> trail = malloc(sizeof(size_t) * p_size);
+        w -> stamp = calloc(p_size, sizeof(size_t));
+        w -> covered = malloc(sizeof(long) * m_size);
+        w -> memo = calloc(EXACT_MEMO_SIZE, sizeof(exact_slot_t));
+        failed = w -> coeff == NULL || w -> forbidden == NULL || w -> trail == NULL || w -> stamp == NULL ||
+                w -> covered == NULL || w -> memo == NULL;
+    }
+    if(failed)
+        work.workers = 0;
+
+    //the main thread is a worker too
+    unsigned started = 1;
+    for(; !failed && started < threads; started++)
+        if(pthread_create(ids + started, NULL, exact_worker, workers + started) != 0){
+            //the workers not started are not waited by the others
+            pthread_mutex_lock(&work.lock);
+            work.workers = started;
+            pthread_mutex_unlock(&work.lock);
+            break;
+        }
+    if(!failed)
+        exact_worker(workers);
+    for(unsigned i = 1; i < started && !failed; i++)
+        pthread_join(ids[i], NULL);
+
+    for(unsigned i = 0; i < ready; i++){
+        e -> nodes += workers[i].nodes;
+        FREE(workers[i].coeff);
+        FREE(workers[i].forbidden);
+        FREE(workers[i].trail);
+        FREE(workers[i].stamp);
+        FREE(workers[i].covered);
+        FREE(workers[i].memo);
+        FREE(workers[i].states);
+    }
+    for(size_t i = 0; i < work.tasks_size; i++){
+        FREE(work.tasks[i].coeff);
+        FREE(work.tasks[i].forbidden);
+    }
+    FREE(work.tasks);
+    FREE(workers);
+    FREE(ids);
+    pthread_mutex_destroy(&work.lock);
+    pthread_cond_destroy(&work.cond);
+    e -> optimal = !failed && !work.stop;
+    return e -> optimal;
+}
+
+/**
+ * Takes subtrees from the stack and visits them, until all the workers are idle and the stack is empty
+ * @param arg The exact_worker_t of the worker
+ * @return NULL
+ */
+void* exact_worker(void* arg){
+    exact_worker_t* w = arg;
+    exact_work_t* work = w -> work;
+    pthread_mutex_lock(&work -> lock);
+    while(true){
+        if(work -> tasks_size > 0){
+            exact_task_t task = work -> tasks[--work -> tasks_size];
+            pthread_mutex_unlock(&work -> lock);
+            exact_load(w, &task);
+            exact_visit(w, task.weight);
+            FREE(task.coeff);
+            FREE(task.forbidden);
+            pthread_mutex_lock(&work -> lock);
+            continue;
+        }
+        if(work -> done)
+            break;
+        work -> idle++;
+        if(work -> idle == work -> workers){
+            work -> done = true;
+            pthread_cond_broadcast(&work -> cond);
+            break;
+        }
+        pthread_cond_wait(&work -> cond, &work -> lock);
+        work -> idle--;
+    }
+    pthread_mutex_unlock(&work -> lock);
+    return NULL;
+}
+
+/**
+ * Sets the state of the worker to the root of the subtree
+ */
+void exact_load(exact_worker_t* w, exact_task_t* task){
+    exact_t* e = w -> work -> e;
+    memset(w -> covered, 0, sizeof(long) * e -> points_size);
+    w -> hash_coeff = 0;
+    w -> hash_forbidden = 0;
+    w -> trail_size = 0;
+    for(size_t p = 0; p < e -> primes_size; p++){
+        w -> coeff[p] = 0;
+        w -> forbidden[p] = task -> forbidden[p];
+        if(task -> forbidden[p])
+            w -> hash_forbidden ^= e -> keys[2 * p + 1];
+        if(task -> coeff[p] != 0)
+            exact_increase(w, p, task -> coeff[p]);
+    }
+}
+
+/**
+ * Visits the subtree of the current state of the worker, restoring it before returning
+ * @param w The worker
+ * @param weight The weight of the current coefficients
+ */
+void exact_visit(exact_worker_t* w, long weight){
+    exact_t* e = w -> work -> e;
+    if(exact_stopped(w))
+        return;
+    if(++w -> nodes % EXACT_CHECK_NODES == 0)
+        exact_check_limits(w);
+
+    //a state already visited has the same subtree
+    if(exact_visited(w))
+        return;
+
+    //the point to cover with the fewest primes allowed
+    size_t point = e -> points_size;
+    size_t point_allowed = SIZE_MAX;
+    for(size_t x = 0; x < e -> points_size; x++){
+        if(w -> covered[x] >= e -> demand[x])
+            continue;
+        size_t allowed = 0;
+        for(size_t i = e -> coverers_start[x]; i < e -> coverers_start[x + 1] && allowed < point_allowed; i++)
+            allowed += !w -> forbidden[e -> coverers[i]];
+        if(allowed < point_allowed){
+            point = x;
+            point_allowed = allowed;
+            if(allowed == 0)
+                return; //it cannot be covered anymore
+        }
+    }
+    if(point == e -> points_size){
+        exact_solution(w, weight);
+        return;
+    }
+    if(weight + exact_bound(w) >= __atomic_load_n(&e -> best_weight, __ATOMIC_RELAXED))
+        return;
+
+    size_t trail_mark = w -> trail_size;
+    uint64_t hash_forbidden = w -> hash_forbidden;
+    size_t left = point_allowed; //branches not yet visited
+    for(size_t i = e -> coverers_start[point]; i < e -> coverers_start[point + 1] && !exact_stopped(w); i++){
+        size_t p = e -> coverers[i];
+        if(w -> forbidden[p])
+            continue;
+        //the last prime allowed has to cover all the residual of the point
+        int amount = left == 1 ? (int) (e -> demand[point] - w -> covered[point]) : 1;
+        //the next branches are visited by the idle workers
+        if(left > 1 && exact_donate(w, weight, point, i + 1))
+            left = 1;
+        exact_increase(w, p, amount);
+        exact_visit(w, weight + amount);
+        exact_increase(w, p, -amount);
+        if(--left == 0)
+            break;
+        exact_forbid(w, p);
+    }
+    while(w -> trail_size > trail_mark)
+        w -> forbidden[w -> trail[--w -> trail_size]] = 0;
+    w -> hash_forbidden = hash_forbidden;
+}
+
+/**
+ * Looks for the current state in the table, comparing the whole state when the hashes match, so that
+ * a collision never cuts a subtree not visited. A state is stored only in an empty slot and while the
+ * states take less than EXACT_MEMO_BYTES, the others are visited again if reached again
+ * @return true if the state has already been visited
+ */
+bool exact_visited(exact_worker_t* w){
+    size_t primes_size = w -> work -> e -> primes_size;
+    size_t coeff_size = sizeof(int) * primes_size;
+    size_t state_size = coeff_size + primes_size;
+    if(state_size == 0)
+        return false;
+    uint64_t hash = w -> hash_coeff ^ w -> hash_forbidden;
+    exact_slot_t* slot = w -> memo + (hash & (EXACT_MEMO_SIZE - 1));
+    if(slot -> state != 0){
+        uint8_t* state = w -> states + slot -> state - 1;
+        return slot -> hash == hash && memcmp(state, w -> coeff, coeff_size) == 0 &&
+            memcmp(state + coeff_size, w -> forbidden, primes_size) == 0;
+    }
+
+    if(w -> states_size + state_size > w -> states_max){
+        size_t new_max = w -> states_max == 0 ? state_size * EXACT_CHECK_NODES : w -> states_max * 2;
+        if(new_max > EXACT_MEMO_BYTES)
+            new_max = EXACT_MEMO_BYTES;
+        if(w -> states_size + state_size > new_max)
+            return false;
+        uint8_t* states = realloc(w -> states, new_max);
+        if(states == NULL)
+            return false;
+        w -> states = states;
+        w -> states_max = new_max;
+    }
+    memcpy(w -> states + w -> states_size, w -> coeff, coeff_size);
+    memcpy(w -> states + w -> states_size + coeff_size, w -> forbidden, primes_size);
+    slot -> hash = hash;
+    slot -> state = w -> states_size + 1;
+    w -> states_size += state_size;
+    return false;
+}
+
+/**
+ * Adds amount (possibly negative) to the coefficient of the prime
+ */
+void exact_increase(exact_worker_t* w, size_t prime, int amount){
+    exact_t* e = w -> work -> e;
+    w -> coeff[prime] += amount;
+    w -> hash_coeff += (uint64_t) (int64_t) amount * e -> keys[2 * prime];
+    for(size_t i = e -> covers_start[prime]; i < e -> covers_start[prime + 1]; i++)
+        w -> covered[e -> covers[i]] += amount;
+}
+
+/**
+ * Forbids to increase the prime in the subtree of the current state, it is allowed again when going back
+ */
+void exact_forbid(exact_worker_t* w, size_t prime){
+    w -> forbidden[prime] = 1;
+    w -> trail[w -> trail_size++] = prime;
+    w -> hash_forbidden ^= w -> work -> e -> keys[2 * prime + 1];
+}
+
+/**
+ * Lower bound of the weight still to add: the sum of the residuals of points such that no allowed prime
+ * covers two of them, since each of them needs its own primes
+ * @return The bound
+ */
+long exact_bound(exact_worker_t* w){
+    exact_t* e = w -> work -> e;
+    long bound = 0;
+    w -> stamp_now++;
+    for(size_t x = 0; x < e -> points_size; x++){
+        long residual = (long) e -> demand[x] - w -> covered[x];
+        if(residual <= 0)
+            continue;
+        bool independent = true;
+        for(size_t i = e -> coverers_start[x]; i < e -> coverers_start[x + 1] && independent; i++)
+            independent = w -> forbidden[e -> coverers[i]] || w -> stamp[e -> coverers[i]] != w -> stamp_now;
+        if(!independent)
+            continue;
+        for(size_t i = e -> coverers_start[x]; i < e -> coverers_start[x + 1]; i++)
+            w -> stamp[e -> coverers[i]] = w -> stamp_now;
+        bound += residual;
+    }
+    return bound;
+}
+
+/**
+ * @return true if the search has to stop
+ */
+bool exact_stopped(exact_worker_t* w){
+    return __atomic_load_n(&w -> work -> stop, __ATOMIC_RELAXED);
+}
+
+/**
+ * Checks the limits, called every EXACT_CHECK_NODES nodes visited by the worker
+ */
+void exact_check_limits(exact_worker_t* w){
+    exact_work_t* work = w -> work;
+    bool stop = false;
+    if(work -> max_nodes > 0)
+        stop = __atomic_add_fetch(&work -> nodes, EXACT_CHECK_NODES, __ATOMIC_RELAXED) >= work -> max_nodes;
+    stop = stop || budget_over(&work -> timer) || budget_over(work -> budget);
+    if(stop)
+        __atomic_store_n(&work -> stop, true, __ATOMIC_RELAXED);
+}
+
+/**
+ * If a worker is idle, adds to the stack all the branches of the current node after the one being visited:
+ * each one has its prime increased and the allowed primes before it forbidden
+ * @param w The worker
+ * @param weight The weight of the current coefficients
+ * @param point The point of the current node
+ * @param from The position in the coverers of the point of the first branch to give, the one before
+ *      is the branch visited by the worker
+ * @return true if the branches have been added to the stack, false if they have to be visited by the worker
+ */
+bool exact_donate(exact_worker_t* w, long weight, size_t point, size_t from){
+    exact_work_t* work = w -> work;
+    exact_t* e = work -> e;
+    if(__atomic_load_n(&work -> idle, __ATOMIC_RELAXED) == 0)
+        return false;
+    size_t p_size = e -> primes_size;
+    uint8_t* forbidden;
+    MALLOC(forbidden, sizeof(uint8_t) * p_size, ;);
+    memcpy(forbidden, w -> forbidden, sizeof(uint8_t) * p_size);
+    forbidden[e -> coverers[from - 1]] = 1;
+    size_t last = e -> coverers_start[point + 1]; //after the last branch
+    while(last > from && forbidden[e -> coverers[last - 1]])
+        last--;
+
+    pthread_mutex_lock(&work -> lock);
+    size_t size = work -> tasks_size;
+    bool given = true;
+    for(size_t i = from; i < last && given; i++){
+        size_t p = e -> coverers[i];
+        if(forbidden[p])
+            continue;
+        if(work -> tasks_size == work -> tasks_max){
+            exact_task_t* tasks = realloc(work -> tasks, sizeof(exact_task_t) * work -> tasks_max * 2);
+            if((given = tasks != NULL)){
+                work -> tasks = tasks;
+                work -> tasks_max *= 2;
+            }
+        }
+        exact_task_t* task = work -> tasks + work -> tasks_size;
+        if(given){
+            task -> coeff = malloc(sizeof(int) * p_size);
+            task -> forbidden = malloc(sizeof(uint8_t) * p_size);
+            given = task -> coeff != NULL && task -> forbidden != NULL;
+        }
+        if(!given){
+            if(work -> tasks_size < work -> tasks_max){
+                FREE(task -> coeff);
+                FREE(task -> forbidden);
+            }
+            break;
+        }
+        int amount = i == last - 1 ? (int) (e -> demand[point] - w -> covered[point]) : 1;
+        memcpy(task -> coeff, w -> coeff, sizeof(int) * p_size);
+        memcpy(task -> forbidden, forbidden, sizeof(uint8_t) * p_size);
+        task -> coeff[p] += amount;
+        task -> weight = weight + amount;
+        work -> tasks_size++;
+        forbidden[p] = 1;
+    }
+    if(!given){
+        //the worker visits all the branches
+        while(work -> tasks_size > size){
+            work -> tasks_size--;
+            FREE(work -> tasks[work -> tasks_size].coeff);
+            FREE(work -> tasks[work -> tasks_size].forbidden);
+        }
+    } else
+        pthread_cond_broadcast(&work -> cond);
+    pthread_mutex_unlock(&work -> lock);
+    FREE(forbidden);
+    return given;
+}
+
+/**
+ * Stores the current coefficients if lighter than the best form
+ */
+void exact_solution(exact_worker_t* w, long weight){
+    exact_t* e = w -> work -> e;
+    pthread_mutex_lock(&w -> work -> lock);
+    if(weight < e -> best_weight){
+        if(e -> best == NULL)
+            e -> best = malloc(sizeof(int) * (e -> primes_size > 0 ? e -> primes_size : 1));
+        if(e -> best != NULL){
+            memcpy(e -> best, w -> coeff, sizeof(int) * e -> primes_size);
+            __atomic_store_n(&e -> best_weight, weight, __ATOMIC_RELAXED);
+        }
+    }
+    pthread_mutex_unlock(&w -> work -> lock);
+}
+
+/**
+ * @return The best form found, a new sopp
+ */
+sopp_t* exact_sopp(exact_t* e){
+    sopp_t* sopp;
+    if(e -> best == NULL){
+        size_t size = 0;
+        productp_t** products = alist_as_array(e -> initial -> arraylist, &size);
+        NULL_CHECK(sopp = sopp_create_wsize(size));
+        for(size_t i = 0; i < size; i++)
+            sopp_add(sopp, products[i]);
+        return sopp;
+    }
+    NULL_CHECK(sopp = sopp_create());
+    for(size_t p = 0; p < e -> primes_size; p++){
+        if(e -> best[p] == 0)
+            continue;
+        productp_t* product = productp_create(e -> primes[p], e -> f -> variables, e -> best[p]);
+        sopp_add(sopp, product);
+        productp_destroy(product);
+    }
+    return sopp;
+}
+
+/**
+ * Frees the memory used by the search
+ */
+void exact_destroy(exact_t* e){
+    if(e != NULL){
+        FREE(e -> primes);
+        FREE(e -> demand);
+        FREE(e -> covers_start);
+        FREE(e -> covers);
+        FREE(e -> coverers_start);
+        FREE(e -> coverers);
+        FREE(e -> keys);
+        FREE(e -> best);
+        sopp_destroy(e -> initial);
+        FREE(e);
+    }
+}
@@ -0,0 +1,58 @@
+/*
+ * Library implementing an exact sopp synthesis: a branch and bound search of the sopp form with minimum
+ * weight (sum of the coefficients) over the prime implicants of the function. For a dense function with up to
+ * EXACT_PRIMES_VARIABLES variables the primes are found checking all the 3^n cubes, so the form is minimal
+ * among all the sopp forms, else the ones of prime_implicants are used.
+ * Each node of the search takes the point to cover with the fewest primes that can still be increased, then
+ * the branch i adds 1 to the coefficient of its i-th prime and forbids the previous ones in its subtree, so that
+ * each form is reached only once. A branch is cut when its weight plus a lower bound (the sum of the residuals
+ * of points no allowed prime covers together) reaches the best form found, dominated primes are removed
+ * before the search and the states already visited are remembered in a table, which keeps the whole states
+ * so that a branch is cut only when its state really has been visited.
+ * The search runs on many threads sharing a stack of subtrees: a busy worker gives the branches it has
+ * not yet visited to the stack when another worker is idle
+ */
+
+#ifndef DSOPP_SYNTHESIS_EXACT_H
+#define DSOPP_SYNTHESIS_EXACT_H
+
+#include <stdint.h>
+#include "bool_plus.h"
+
+//max variables of a dense function whose primes are found checking all the cubes
+#define EXACT_PRIMES_VARIABLES 14
+
+//nodes visited by a worker between two checks of the limits
+#define EXACT_CHECK_NODES 1024
+
+//slots of the table of the states visited by each worker, a power of 2
+#define EXACT_MEMO_SIZE (1 << 18)
+//max bytes of the states stored in the table of each worker
+#define EXACT_MEMO_BYTES ((size_t) 64 << 20)
+
+typedef struct{
+    fplus_t* f; //the function, only read
+    cube_t* primes; //the prime implicants not dominated by others, by number of points covered
+    size_t primes_size; //size of above array
+    unsigned* demand; //value of each point to cover, in descending order
+    size_t points_size; //size of above array
+    size_t* covers_start; //the points covered by the prime p are covers[covers_start[p] .. covers_start[p + 1])
+    size_t* covers;
+    size_t* coverers_start; //the primes covering the point x are coverers[coverers_start[x] .. coverers_start[x + 1])
+    size_t* coverers;
+    uint64_t* keys; //two random keys for each prime, to hash its coefficient and if it is forbidden
+    long best_weight; //weight of the best form found
+    int* best; //coefficients of the primes in the best form, NULL if it is the initial one
+    sopp_t* initial; //the lightest form found by the other syntheses
+    bool optimal; //true if the best form has been proved minimal
+    size_t nodes; //nodes visited by the search
+}exact_t;
+
+//finds the primes and the lightest form of the other syntheses, the greedy one within the budget (NULL for none)
+exact_t* exact_create(fplus_t*, budget_t*);
+//searches the minimum weight form, stops at the given limits (0 or NULL for none), true if it is proved minimal
+bool exact_search(exact_t*, unsigned threads, size_t max_nodes, double max_seconds, budget_t*);
+sopp_t* exact_sopp(exact_t*); //returns the best form found
+void exact_destroy(exact_t*); //frees the memory used
+
+#endif //DSOPP_SYNTHESIS_EXACT_H
@@ -0,0 +1,346 @@
+#include <string.h>
+#include "frozen.h"
+#include "utils.h"
+
+//entries of the cache of the additions of two diagrams, a lost entry is computed again
+#define FROZEN_CACHE_SIZE (1 << 16)
+
+//error value returned in place of a node
+#define FROZEN_ERROR SIZE_MAX
+
+//an addition of two nodes already done
+typedef struct{
+    size_t a;
+    size_t b;
+    size_t result; //FROZEN_ERROR if the entry is empty
+}frozen_cache_t;
+
+//internal functions
+frozen_t* frozen_alloc(unsigned variables);
+bool frozen_fill_table(frozen_t* frozen, productp_t** products, size_t size);
+bool frozen_build_diagram(frozen_t* frozen, productp_t** products, size_t size);
+size_t frozen_node(frozen_t* frozen, unsigned variable, size_t low, size_t high);
+size_t frozen_product(frozen_t* frozen, cube_t c, int coeff);
+size_t frozen_add(frozen_t* frozen, size_t a, size_t b, frozen_cache_t* cache);
+size_t* frozen_slot(frozen_t* frozen, frozen_node_t node);
+bool frozen_grow(frozen_t* frozen);
+bool frozen_compact(frozen_t* frozen);
+size_t frozen_hashcode(frozen_node_t node);
+
+/**
+ * Freezes the form: up to FROZEN_TABLE_VARIABLES variables (and natural coefficients summing up to
+ * at most UINT32_MAX) the outputs are stored in a table, else in a decision diagram
+ * @param sopp The sopp (or dsopp) form, it can be changed or destroyed after the call
+ * @param variables The number of variables of the products
+ * @return A pointer to the frozen form
+ */
+frozen_t* frozen_create(sopp_t* sopp, unsigned variables){
+    size_t size = 0;
+    productp_t** products = alist_as_array(sopp -> arraylist, &size);
+    bool table = variables <= FROZEN_TABLE_VARIABLES;
+    unsigned long sum = 0;
+    for(size_t i = 0; i < size && table; i++){
+        table = products[i] -> coeff >= 0;
+        sum += (unsigned long) products[i] -> coeff;
+        table = table && sum <= UINT32_MAX;
+    }
+    if(!table)
+        return frozen_create_wdiagram(sopp, variables);
+
+    frozen_t* frozen;
+    NULL_CHECK(frozen = frozen_alloc(variables));
+    if((frozen -> table = fvalues_create((size_t) 1 << variables, (unsigned) sum)) == NULL ||
+            !frozen_fill_table(frozen, products, size)){
+        frozen_destroy(frozen);
+        return NULL;
+    }
+    return frozen;
+}
+
+/**
+ * Freezes the form as a decision diagram, whatever the number of variables
+ * @param sopp The sopp (or dsopp) form, it can be changed or destroyed after the call
+ * @param variables The number of variables of the products
+ * @return A pointer to the frozen form
+ */
+frozen_t* frozen_create_wdiagram(sopp_t* sopp, unsigned variables){
+    size_t size = 0;
+    productp_t** products = alist_as_array(sopp -> arraylist, &size);
+    frozen_t* frozen;
+    NULL_CHECK(frozen = frozen_alloc(variables));
+    if(!frozen_build_diagram(frozen, products, size)){
+        frozen_destroy(frozen);
+        return NULL;
+    }
+    return frozen;
+}
+
+/**
+ * @return A frozen form with no table and no nodes
+ */
+frozen_t* frozen_alloc(unsigned variables){
+    frozen_t* frozen;
+    MALLOC(frozen, sizeof(frozen_t), ;);
+    frozen -> variables = variables;
+    frozen -> table = NULL;
+    frozen -> nodes = NULL;
+    frozen -> nodes_size = 0;
+    frozen -> nodes_max = 0;
+    frozen -> root = 0;
+    frozen -> unique = NULL;
+    frozen -> unique_size = 0;
+    return frozen;
+}
+
+/**
+ * Adds the coefficient of each product to the points it covers, one run of consecutive points at a time
+ * @return The outcome of the operation
+ */
+bool frozen_fill_table(frozen_t* frozen, productp_t** products, size_t size){
+    for(size_t i = 0; i < size; i++){
+        if(products[i] -> coeff == 0)
+            continue;
+        cube_t c = products[i] -> b_product.cube;
+        size_t run_size;
+        cword_t high = cube_runs(c, frozen -> variables, &run_size);
+        cword_t subset = 0;
+        do{
+            fvalues_add_run(frozen -> table, c.value | subset, run_size, (unsigned) products[i] -> coeff);
+            subset = (subset - high) & high;
+        }while(subset != 0);
+    }
+    return true;
+}
+
+/**
+ * Builds the diagram adding the diagram of each product (a chain of nodes, one per literal) to the sum
+ * of the previous ones. Equal nodes are shared and a node whose children are equal is skipped, then
+ * the nodes no longer reachable from the root are dropped
+ * @return The outcome of the operation
+ */
+bool frozen_build_diagram(frozen_t* frozen, productp_t** products, size_t size){
+    frozen -> nodes_max = FROZEN_INIT_SIZE;
+    frozen -> unique_size = FROZEN_INIT_SIZE * 2;
+    MALLOC(frozen -> nodes, sizeof(frozen_node_t) * frozen -> nodes_max, ;);
+    MALLOC(frozen -> unique, sizeof(size_t) * frozen -> unique_size, ;);
+    memset(frozen -> unique, 0, sizeof(size_t) * frozen -> unique_size);
+    frozen_cache_t* cache;
+    MALLOC(cache, sizeof(frozen_cache_t) * FROZEN_CACHE_SIZE, ;);
+    //the nodes are never moved while building, so the cache stays valid across the sums
+    for(size_t j = 0; j < FROZEN_CACHE_SIZE; j++)
+        cache[j].result = FROZEN_ERROR;
+
+    size_t root = frozen_node(frozen, frozen -> variables, 0, 0);
+    for(size_t i = 0; i < size && root != FROZEN_ERROR; i++){
+        size_t product = frozen_product(frozen, products[i] -> b_product.cube, products[i] -> coeff);
+        if(product == FROZEN_ERROR){
+            root = FROZEN_ERROR;
+            break;
+        }
+        root = frozen_add(frozen, root, product, cache);
+    }
+    FREE(cache);
+    FREE(frozen -> unique);
+    frozen -> unique_size = 0;
+    if(root == FROZEN_ERROR)
+        return false;
+    frozen -> root = root;
+    return frozen_compact(frozen);
+}
+
+/**
+ * Returns the node with the given variable and children, it is added only if there is not an equal one.
+ * A node with equal children is not added, the child is returned
+ * @param frozen The form being built
+ * @param variable The variable tested, frozen -> variables for a leaf
+ * @param low The node reached if the variable is 0, the output for a leaf
+ * @param high The node reached if the variable is 1, 0 for a leaf
+ * @return The position of the node, FROZEN_ERROR in case of error
+ */
+size_t frozen_node(frozen_t* frozen, unsigned variable, size_t low, size_t high){
+    if(variable < frozen -> variables && low == high)
+        return low;
+    frozen_node_t node = {variable, low, high};
+    size_t* slot = frozen_slot(frozen, node);
+    if(*slot != 0)
+        return *slot - 1;
+
+    if(frozen -> nodes_size == frozen -> nodes_max){
+        REALLOC(frozen -> nodes, sizeof(frozen_node_t) * frozen -> nodes_max * 2, return FROZEN_ERROR);
+        frozen -> nodes_max *= 2;
+    }
+    frozen -> nodes[frozen -> nodes_size++] = node;
+    *slot = frozen -> nodes_size;
+    if(frozen -> nodes_size > frozen -> unique_size * GOOD_LOAD && !frozen_grow(frozen))
+        return FROZEN_ERROR;
+    return frozen -> nodes_size - 1;
+}
+
+/**
+ * @return The root of the diagram of a single product, FROZEN_ERROR in case of error
+ */
+size_t frozen_product(frozen_t* frozen, cube_t c, int coeff){
+    size_t zero = frozen_node(frozen, frozen -> variables, 0, 0);
+    size_t node = frozen_node(frozen, frozen -> variables, (size_t) (long) coeff, 0);
+    //from the last variable to the first one, so that the children are added before their parent
+    for(cword_t care = c.care; care != 0 && node != FROZEN_ERROR && zero != FROZEN_ERROR; care &= care - 1){
+        unsigned bit = (unsigned) __builtin_ctzll(care);
+        unsigned variable = frozen -> variables - bit - 1;
+        if((c.value >> bit) & 1)
+            node = frozen_node(frozen, variable, zero, node);
+        else
+            node = frozen_node(frozen, variable, node, zero);
+    }
+    return zero == FROZEN_ERROR ? FROZEN_ERROR : node;
+}
+
+/**
+ * Adds two diagrams, the outputs of the leaves reached by a point are summed
+ * @param frozen The form being built
+ * @param a The root of the first diagram
+ * @param b The root of the second diagram
+ * @param cache The additions already done
+ * @return The root of the sum, FROZEN_ERROR in case of error
+ */
+size_t frozen_add(frozen_t* frozen, size_t a, size_t b, frozen_cache_t* cache){
+    //copies, nodes may be moved by the nodes added
+    frozen_node_t na = frozen -> nodes[a];
+    frozen_node_t nb = frozen -> nodes[b];
+    if(na.variable == frozen -> variables && nb.variable == frozen -> variables)
+        return frozen_node(frozen, frozen -> variables, (size_t) ((long) na.low + (long) nb.low), 0);
+    if(na.variable == frozen -> variables && na.low == 0)
+        return b;
+    if(nb.variable == frozen -> variables && nb.low == 0)
+        return a;
+
+    if(a > b){
+        size_t t = a; a = b; b = t;
+        frozen_node_t nt = na; na = nb; nb = nt;
+    }
+    frozen_cache_t* entry = cache + (cube_hashcode((cube_t){a, b}) & (FROZEN_CACHE_SIZE - 1));
+    if(entry -> result != FROZEN_ERROR && entry -> a == a && entry -> b == b)
+        return entry -> result;
+
+    unsigned variable = na.variable < nb.variable ? na.variable : nb.variable;
+    size_t low = frozen_add(frozen, na.variable == variable ? na.low : a, nb.variable == variable ? nb.low : b, cache);
+    if(low == FROZEN_ERROR)
+        return FROZEN_ERROR;
+    size_t high = frozen_add(frozen, na.variable == variable ? na.high : a, nb.variable == variable ? nb.high : b,
+                             cache);
+    if(high == FROZEN_ERROR)
+        return FROZEN_ERROR;
+    size_t result = frozen_node(frozen, variable, low, high);
+
+    entry = cache + (cube_hashcode((cube_t){a, b}) & (FROZEN_CACHE_SIZE - 1));
+    entry -> a = a;
+    entry -> b = b;
+    entry -> result = result;
+    return result;
+}
+
+/**
+ * @return The slot of the unique table containing the node or the empty slot where it should be stored
+ */
+size_t* frozen_slot(frozen_t* frozen, frozen_node_t node){
+    size_t mask = frozen -> unique_size - 1;
+    size_t i = frozen_hashcode(node) & mask;
+    while(frozen -> unique[i] != 0){
+        frozen_node_t* other = frozen -> nodes + frozen -> unique[i] - 1;
+        if(other -> variable == node.variable && other -> low == node.low && other -> high == node.high)
+            break;
+        i = (i + 1) & mask;
+    }
+    return frozen -> unique + i;
+}
+
+/**
+ * Doubles the size of the unique table, then rehashes all the nodes
+ * @return The outcome of the operation
+ */
+bool frozen_grow(frozen_t* frozen){
+    FREE(frozen -> unique);
+    frozen -> unique_size *= 2;
+    MALLOC(frozen -> unique, sizeof(size_t) * frozen -> unique_size, ;);
+    memset(frozen -> unique, 0, sizeof(size_t) * frozen -> unique_size);
+    for(size_t i = 0; i < frozen -> nodes_size; i++)
+        *frozen_slot(frozen, frozen -> nodes[i]) = i + 1;
+    return true;
+}
+
+/**
+ * Removes the nodes not reachable from the root, keeping the children before their parents
+ * @return The outcome of the operation
+ */
+bool frozen_compact(frozen_t* frozen){
+    size_t* position;
+    MALLOC(position, sizeof(size_t) * frozen -> nodes_size, ;);
+    for(size_t i = 0; i < frozen -> nodes_size; i++)
+        position[i] = FROZEN_ERROR;
+
+    //a parent comes after its children, so a backward visit marks all the reachable nodes
+    position[frozen -> root] = 0;
+    for(size_t i = frozen -> root + 1; i-- > 0;){
+        frozen_node_t* node = frozen -> nodes + i;
+        if(position[i] == FROZEN_ERROR || node -> variable == frozen -> variables)
+            continue;
+        position[node -> low] = 0;
+        position[node -> high] = 0;
+    }
+
+    size_t size = 0;
+    for(size_t i = 0; i <= frozen -> root; i++){
+        if(position[i] == FROZEN_ERROR)
+            continue;
+        frozen_node_t node = frozen -> nodes[i];
+        if(node.variable < frozen -> variables){
+            node.low = position[node.low];
+            node.high = position[node.high];
+        }
+        position[i] = size;
+        frozen -> nodes[size++] = node;
+    }
+    frozen -> root = position[frozen -> root];
+    frozen -> nodes_size = size;
+    frozen -> nodes_max = size;
+    REALLOC(frozen -> nodes, sizeof(frozen_node_t) * size, FREE(position); return false);
+    FREE(position);
+    return true;
+}
+
+/**
+ * @return An hashcode of the node
+ */
+size_t frozen_hashcode(frozen_node_t node){
+    return cube_hashcode((cube_t){(cword_t) node.high << 7 ^ node.variable, node.low});
+}
+
+/**
+ * @param frozen The frozen form
+ * @param input The values of the variables
+ * @return The output of the form with the given input
+ */
+long frozen_value_of(frozen_t* frozen, bool input[]){
+    point_t point = 0;
+    for(unsigned i = 0; i < frozen -> variables; i++)
+        point = (point << 1) | (input[i] & 1);
+    return frozen_value_at(frozen, point);
+}
+
+/**
+ * @return The number of nodes of the decision diagram, 0 if the form is stored as a table
+ */
+size_t frozen_nodes(frozen_t* frozen){
+    return frozen -> table == NULL ? frozen -> nodes_size : 0;
+}
+
+/**
+ * Frees the memory used by the frozen form
+ */
+void frozen_destroy(frozen_t* frozen){
+    if(frozen != NULL){
+        fvalues_destroy(frozen -> table);
+        FREE(frozen -> nodes);
+        FREE(frozen -> unique);
+        FREE(frozen);
+    }
+}
@@ -0,0 +1,56 @@
+/*
+ * Library implementing a sopp (or dsopp) form frozen in a structure answering each query
+ * without looking at the products. Up to FROZEN_TABLE_VARIABLES variables the output of each point
+ * is stored in a table, filled adding the coefficient of each product on the runs of consecutive
+ * points it covers. With more variables the form becomes a reduced ordered decision diagram
+ * with the outputs in the leaves, so that a query follows at most one node per variable
+ */
+
+#ifndef DSOPP_SYNTHESIS_FROZEN_H
+#define DSOPP_SYNTHESIS_FROZEN_H
+
+#include "bool_plus.h"
+
+//max number of variables of a form stored as a table of outputs
+#define FROZEN_TABLE_VARIABLES 24
+
+//initial number of slots of the table of unique nodes of a decision diagram
+#define FROZEN_INIT_SIZE 1024
+
+//a node of a decision diagram, a leaf if variable equals the variables of the form
+typedef struct{
+    unsigned variable; //variable tested by the node
+    size_t low; //node reached if the variable is 0, for a leaf its output
+    size_t high; //node reached if the variable is 1
+}frozen_node_t;
+
+typedef struct{
+    unsigned variables; //number of variables of the form
+    fvalues_t* table; //output of each point, NULL if the form is a decision diagram
+    frozen_node_t* nodes; //nodes of the diagram, the children of a node come before it
+    size_t nodes_size; //number of nodes
+    size_t nodes_max; //size of above array
+    size_t root; //first node visited by a query
+    size_t* unique; //open addressing table with the position + 1 of each node, to share equal nodes
+    size_t unique_size; //number of slots, a power of 2
+}frozen_t;
+
+frozen_t* frozen_create(sopp_t*, unsigned variables); //freezes the form
+frozen_t* frozen_create_wdiagram(sopp_t*, unsigned variables); //freezes the form as a decision diagram
+long frozen_value_of(frozen_t*, bool* input); //returns the output of the form with the given variables values
+size_t frozen_nodes(frozen_t*); //returns the number of nodes of the diagram, 0 if it is a table
+void frozen_destroy(frozen_t*); //frees the memory used
+
+//returns the output of the form at the given point (decimal)
+static inline long frozen_value_at(const frozen_t* frozen, point_t point){
+    if(frozen -> table != NULL)
+        return fvalues_get(frozen -> table, point);
+    const frozen_node_t* node = frozen -> nodes + frozen -> root;
+    while(node -> variable < frozen -> variables){
+        bool bit = (point >> (frozen -> variables - node -> variable - 1)) & 1;
+        node = frozen -> nodes + (bit ? node -> high : node -> low);
+    }
+    return (long) node -> low;
+}
+
+#endif //DSOPP_SYNTHESIS_FROZEN_H
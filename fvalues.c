@@ -0,0 +1,376 @@
+#include <string.h>
+#include "fvalues.h"
+#include "utils.h"
+
+/*
+ * Vectors used by the kernels on runs of 1 byte values, AVX2 if enabled at compile time, else SSE2.
+ * Without either of them (or for wider values) the plain loops are used
+ */
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define FVEC_LANES 32
+typedef __m256i fvec_t;
+#define FVEC_LOAD(p) _mm256_loadu_si256((const __m256i*) (p))
+#define FVEC_STORE(p, x) _mm256_storeu_si256((__m256i*) (p), x)
+#define FVEC_SET1(x) _mm256_set1_epi8((char) (x))
+#define FVEC_SUBS(a, b) _mm256_subs_epu8(a, b)
+#define FVEC_SUB(a, b) _mm256_sub_epi8(a, b)
+#define FVEC_MAX(a, b) _mm256_max_epu8(a, b)
+#define FVEC_MIN(a, b) _mm256_min_epu8(a, b)
+#define FVEC_EQ(a, b) _mm256_cmpeq_epi8(a, b)
+#define FVEC_MASK(x) ((cword_t) (uint32_t) _mm256_movemask_epi8(x))
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define FVEC_LANES 16
+typedef __m128i fvec_t;
+#define FVEC_LOAD(p) _mm_loadu_si128((const __m128i*) (p))
+#define FVEC_STORE(p, x) _mm_storeu_si128((__m128i*) (p), x)
+#define FVEC_SET1(x) _mm_set1_epi8((char) (x))
+#define FVEC_SUBS(a, b) _mm_subs_epu8(a, b)
+#define FVEC_SUB(a, b) _mm_sub_epi8(a, b)
+#define FVEC_MAX(a, b) _mm_max_epu8(a, b)
+#define FVEC_MIN(a, b) _mm_min_epu8(a, b)
+#define FVEC_EQ(a, b) _mm_cmpeq_epi8(a, b)
+#define FVEC_MASK(x) ((cword_t) (uint16_t) _mm_movemask_epi8(x))
+#endif
+
+//internal functions
+unsigned fvalues_width(unsigned max_value);
+bool fvalues_widen(fvalues_t* v, unsigned width);
+
+//loops specialized for each width, so that the compiler can vectorize them
+#define FVALUES_FOR_EACH_WIDTH(v, type, body)\
+    switch((v) -> width){\
+        case 1: { typedef uint8_t type; body } break;\
+        case 2: { typedef uint16_t type; body } break;\
+        default: { typedef uint32_t type; body } break;\
+    }
+
+/**
+ * @return The number of bytes needed to store the given value
+ */
+unsigned fvalues_width(unsigned max_value){
+    if(max_value <= UINT8_MAX)
+        return 1;
+    if(max_value <= UINT16_MAX)
+        return 2;
+    return 4;
+}
+
+/**
+ * Creates an array of values all set to 0, none of them is a don't care
+ * @param size The number of values
+ * @param max_value The max value expected, it only decides the initial width
+ * @return A pointer to the array
+ */
+fvalues_t* fvalues_create(size_t size, unsigned max_value){
+    fvalues_t* v;
+    MALLOC(v, sizeof(fvalues_t), ;);
+    v -> width = fvalues_width(max_value);
+    v -> size = size;
+    size_t words = size / CWORD_BITS + 1;
+    MALLOC(v -> data, v -> width * (size > 0 ? size : 1), FREE(v));
+    MALLOC(v -> dont_cares, sizeof(cword_t) * words, FREE(v -> data); FREE(v));
+    memset(v -> data, 0, v -> width * size);
+    memset(v -> dont_cares, 0, sizeof(cword_t) * words);
+    return v;
+}
+
+/**
+ * Changes the number of values stored, the first ones are kept and the new ones are set to 0
+ * @param v The array
+ * @param size The new number of values
+ * @return The outcome of the operation
+ */
+bool fvalues_resize(fvalues_t* v, size_t size){
+    size_t old_words = v -> size / CWORD_BITS + 1;
+    size_t words = size / CWORD_BITS + 1;
+    REALLOC(v -> data, v -> width * (size > 0 ? size : 1), return false);
+    REALLOC(v -> dont_cares, sizeof(cword_t) * words, return false);
+    if(size > v -> size){
+        memset((char*) v -> data + v -> width * v -> size, 0, v -> width * (size - v -> size));
+        memset(v -> dont_cares + old_words, 0, sizeof(cword_t) * (words - old_words));
+        //bits of the last old word above the old size
+        v -> dont_cares[old_words - 1] &= CUBE_MASK(v -> size % CWORD_BITS);
+    }
+    v -> size = size;
+    return true;
+}
+
+/**
+ * @return A copy of the array, with the same width
+ */
+fvalues_t* fvalues_copy(fvalues_t* v){
+    fvalues_t* copy;
+    MALLOC(copy, sizeof(fvalues_t), ;);
+    *copy = *v;
+    size_t words = v -> size / CWORD_BITS + 1;
+    MALLOC(copy -> data, v -> width * (v -> size > 0 ? v -> size : 1), FREE(copy));
+    MALLOC(copy -> dont_cares, sizeof(cword_t) * words, FREE(copy -> data); FREE(copy));
+    memcpy(copy -> data, v -> data, v -> width * v -> size);
+    memcpy(copy -> dont_cares, v -> dont_cares, sizeof(cword_t) * words);
+    return copy;
+}
+
+/**
+ * Moves the values to a bigger width
+ * @return The outcome of the operation
+ */
+bool fvalues_widen(fvalues_t* v, unsigned width){
+    void* data;
+    MALLOC(data, width * (v -> size > 0 ? v -> size : 1), ;);
+    for(size_t i = 0; i < v -> size; i++){
+        unsigned value = fvalues_get(v, i);
+        if(width == 2)
+            ((uint16_t*) data)[i] = (uint16_t) value;
+        else
+            ((uint32_t*) data)[i] = value;
+    }
+    FREE(v -> data);
+    v -> data = data;
+    v -> width = width;
+    return true;
+}
+
+/**
+ * Sets the i-th value, the array is widened if the value does not fit
+ * @param v The array
+ * @param i The position, lower than the size
+ * @param value The value, if negative the position becomes a don't care (and has value 0)
+ * @return The outcome of the operation
+ */
+bool fvalues_set(fvalues_t* v, size_t i, int value){
+    cword_t bit = (cword_t) 1 << (i % CWORD_BITS);
+    if(value < 0){
+        v -> dont_cares[i / CWORD_BITS] |= bit;
+        value = 0;
+    } else
+        v -> dont_cares[i / CWORD_BITS] &= ~bit;
+
+    unsigned width = fvalues_width((unsigned) value);
+    if(width > v -> width && !fvalues_widen(v, width))
+        return false;
+    switch(v -> width){
+        case 1:
+            ((uint8_t*) v -> data)[i] = (uint8_t) value;
+            break;
+        case 2:
+            ((uint16_t*) v -> data)[i] = (uint16_t) value;
+            break;
+        default:
+            ((uint32_t*) v -> data)[i] = (uint32_t) value;
+    }
+    return true;
+}
+
+/**
+ * Sets in the bitmap the positions with value 0 which are not don't care, the others are cleared
+ * @param v The array
+ * @param size The number of values to check, from the first one
+ * @param bitmap A bitmap with at least size / CWORD_BITS + 1 words
+ */
+void fvalues_zeros(fvalues_t* v, size_t size, cword_t* bitmap){
+    size_t words = size / CWORD_BITS + 1;
+    FVALUES_FOR_EACH_WIDTH(v, value_t,
+        const value_t* data = v -> data;
+        for(size_t w = 0; w < words; w++){
+            size_t base = w * CWORD_BITS;
+            size_t bits = size - base < CWORD_BITS ? size - base : CWORD_BITS;
+            cword_t word = 0;
+            for(size_t b = 0; b < bits; b++)
+                word |= (cword_t) (data[base + b] == 0) << b;
+            bitmap[w] = word & ~v -> dont_cares[w];
+        }
+    )
+}
+
+/**
+ * Sets in the bitmap the positions with value greater than lower, the others are cleared.
+ * Don't care points are never set, since they have value 0
+ * @param v The array
+ * @param size The number of values to check, from the first one
+ * @param lower The threshold
+ * @param bitmap A bitmap with at least size / CWORD_BITS + 1 words
+ * @return The lowest value greater than lower, 0 if there are none
+ */
+unsigned fvalues_above(fvalues_t* v, size_t size, unsigned lower, cword_t* bitmap){
+    size_t words = size / CWORD_BITS + 1;
+    unsigned lowest = UINT32_MAX;
+    FVALUES_FOR_EACH_WIDTH(v, value_t,
+        const value_t* data = v -> data;
+        for(size_t w = 0; w < words; w++){
+            size_t base = w * CWORD_BITS;
+            size_t bits = size - base < CWORD_BITS ? size - base : CWORD_BITS;
+            cword_t word = 0;
+            for(size_t b = 0; b < bits; b++){
+                unsigned value = data[base + b];
+                word |= (cword_t) (value > lower) << b;
+                lowest = value > lower && value < lowest ? value : lowest;
+            }
+            bitmap[w] = word;
+        }
+    )
+    return lowest == UINT32_MAX ? 0 : lowest;
+}
+
+/**
+ * Subtracts the decrement to the values in [start, start + size), the values reaching 0 (or below 0
+ * if disjoint) become don't cares. Don't cares stay don't cares, as done by fplus_sub2value_sopp
+ * and fplus_sub2value_dsopp
+ * @param v The array
+ * @param start The first position
+ * @param size The number of positions
+ * @param decrement The amount to subtract
+ * @param disjoint false to mark as don't care the values reaching 0, true only for the ones below 0
+ */
+void fvalues_sub_run(fvalues_t* v, size_t start, size_t size, unsigned decrement, bool disjoint){
+    size_t i = start, end = start + size;
+#ifdef FVEC_LANES
+    if(v -> width == 1 && decrement <= UINT8_MAX && start % FVEC_LANES == 0){
+        uint8_t* data = v -> data;
+        fvec_t d = FVEC_SET1(decrement);
+        fvec_t zero = FVEC_SET1(0);
+        for(; i + FVEC_LANES <= end; i += FVEC_LANES){
+            fvec_t x = FVEC_LOAD(data + i);
+            fvec_t r = FVEC_SUBS(x, d);
+            //value <= decrement <=> saturated difference is 0, value < decrement <=> max(value, decrement) != value
+            cword_t dc = disjoint ? ~FVEC_MASK(FVEC_EQ(FVEC_MAX(x, d), x)) & CUBE_MASK(FVEC_LANES)
+                    : FVEC_MASK(FVEC_EQ(r, zero));
+            FVEC_STORE(data + i, r);
+            v -> dont_cares[i / CWORD_BITS] |= dc << (i % CWORD_BITS);
+        }
+    }
+#endif
+    FVALUES_FOR_EACH_WIDTH(v, value_t,
+        value_t* data = v -> data;
+        for(; i < end; i++){
+            unsigned value = data[i];
+            bool dc = disjoint ? value < decrement : value <= decrement;
+            data[i] = (value_t) (dc ? 0 : value - decrement);
+            v -> dont_cares[i / CWORD_BITS] |= (cword_t) dc << (i % CWORD_BITS);
+        }
+    )
+}
+
+/**
+ * Adds the increment to the values in [start, start + size), the width is not changed so the
+ * array has to be wide enough for the results. The bitmap of don't cares is not changed
+ * @param v The array
+ * @param start The first position
+ * @param size The number of positions
+ * @param increment The amount to add
+ */
+void fvalues_add_run(fvalues_t* v, size_t start, size_t size, unsigned increment){
+    size_t end = start + size;
+    FVALUES_FOR_EACH_WIDTH(v, value_t,
+        value_t* data = v -> data;
+        for(size_t i = start; i < end; i++)
+            data[i] = (value_t) (data[i] + increment);
+    )
+}
+
+/**
+ * @param v The array
+ * @param start The first position
+ * @param size The number of positions
+ * @return The max value in [start, start + size), don't cares count as 0
+ */
+unsigned fvalues_max_run(fvalues_t* v, size_t start, size_t size){
+    size_t i = start, end = start + size;
+    unsigned max = 0;
+#ifdef FVEC_LANES
+    if(v -> width == 1 && start % FVEC_LANES == 0 && size >= FVEC_LANES){
+        const uint8_t* data = v -> data;
+        fvec_t acc = FVEC_SET1(0);
+        for(; i + FVEC_LANES <= end; i += FVEC_LANES)
+            acc = FVEC_MAX(acc, FVEC_LOAD(data + i));
+        uint8_t lanes[FVEC_LANES];
+        FVEC_STORE(lanes, acc);
+        for(int l = 0; l < FVEC_LANES; l++)
+            max = lanes[l] > max ? lanes[l] : max;
+    }
+#endif
+    FVALUES_FOR_EACH_WIDTH(v, value_t,
+        const value_t* data = v -> data;
+        for(; i < end; i++)
+            max = data[i] > max ? data[i] : max;
+    )
+    return max;
+}
+
+/**
+ * @param v The array
+ * @param start The first position
+ * @param size The number of positions
+ * @param zeros Set to true if in [start, start + size) there is a 0 which is not a don't care,
+ *      left unchanged otherwise
+ * @return The min value greater than 0 in [start, start + size), 0 if there are none
+ */
+unsigned fvalues_min_run(fvalues_t* v, size_t start, size_t size, bool* zeros){
+    size_t i = start, end = start + size;
+    unsigned min = UINT32_MAX;
+#ifdef FVEC_LANES
+    if(v -> width == 1 && start % FVEC_LANES == 0 && size >= FVEC_LANES){
+        const uint8_t* data = v -> data;
+        fvec_t one = FVEC_SET1(1);
+        fvec_t zero = FVEC_SET1(0);
+        //value - 1 wraps the zeros to 255, that is never reached by a value greater than 0
+        fvec_t acc = FVEC_SET1(UINT8_MAX);
+        for(; i + FVEC_LANES <= end; i += FVEC_LANES){
+            fvec_t x = FVEC_LOAD(data + i);
+            acc = FVEC_MIN(acc, FVEC_SUB(x, one));
+            cword_t dc = v -> dont_cares[i / CWORD_BITS] >> (i % CWORD_BITS);
+            if(FVEC_MASK(FVEC_EQ(x, zero)) & ~dc & CUBE_MASK(FVEC_LANES))
+                *zeros = true;
+        }
+        uint8_t lanes[FVEC_LANES];
+        FVEC_STORE(lanes, acc);
+        for(int l = 0; l < FVEC_LANES; l++)
+            if(lanes[l] != UINT8_MAX && lanes[l] + 1u < min)
+                min = lanes[l] + 1u;
+    }
+#endif
+    FVALUES_FOR_EACH_WIDTH(v, value_t,
+        const value_t* data = v -> data;
+        for(; i < end; i++){
+            unsigned value = data[i];
+            if(value == 0)
+                *zeros = *zeros || !fvalues_is_dont_care(v, i);
+            else if(value < min)
+                min = value;
+        }
+    )
+    return min == UINT32_MAX ? 0 : min;
+}
+
+/**
+ * @param v The array
+ * @param start The first position
+ * @param size The number of positions
+ * @return true if all the values in [start, start + size) are don't cares
+ */
+bool fvalues_dont_care_run(fvalues_t* v, size_t start, size_t size){
+    size_t i = start, end = start + size;
+    //bits before the first full word
+    for(; i < end && i % CWORD_BITS != 0; i++)
+        if(!fvalues_is_dont_care(v, i))
+            return false;
+    for(; i + CWORD_BITS <= end; i += CWORD_BITS)
+        if(v -> dont_cares[i / CWORD_BITS] != ~(cword_t) 0)
+            return false;
+    for(; i < end; i++)
+        if(!fvalues_is_dont_care(v, i))
+            return false;
+    return true;
+}
+
+/**
+ * Frees the memory used by the array
+ */
+void fvalues_destroy(fvalues_t* v){
+    if(v != NULL){
+        FREE(v -> data);
+        FREE(v -> dont_cares);
+        FREE(v);
+    }
+}
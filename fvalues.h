@@ -0,0 +1,58 @@
+/*
+ * Library implementing a compact array with the outputs of a boolean plus function.
+ * Each value takes 1, 2 or 4 bytes depending on the max value stored, the array is widened
+ * when a bigger value is set. The don't care points are kept in a separate bitmap, in the array
+ * they have value 0, so that loops on the values do not have to check a special value
+ */
+
+#ifndef DSOPP_SYNTHESIS_FVALUES_H
+#define DSOPP_SYNTHESIS_FVALUES_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "bool_utils.h"
+
+typedef struct{
+    void* data; //the values, each one of width bytes
+    unsigned width; //bytes used by each value: 1, 2 or 4
+    cword_t* dont_cares; //bit i set <=> the i-th value is a don't care
+    size_t size; //number of values that can be stored
+}fvalues_t;
+
+fvalues_t* fvalues_create(size_t size, unsigned max_value); //creates an array of zeros, wide enough for max_value
+bool fvalues_resize(fvalues_t*, size_t size); //changes the number of values, new ones are zeros
+fvalues_t* fvalues_copy(fvalues_t*); //returns a copy of the array
+bool fvalues_set(fvalues_t*, size_t i, int value); //sets a value, a negative one marks a don't care
+//sets in the bitmap the first size values that are 0 and not don't care
+void fvalues_zeros(fvalues_t*, size_t size, cword_t* bitmap);
+//sets in the bitmap the first size values greater than lower, returns the lowest of them (0 if none)
+unsigned fvalues_above(fvalues_t*, size_t size, unsigned lower, cword_t* bitmap);
+//subtracts the decrement to the values in [start, start + size), the ones reaching 0 become don't cares
+//(with disjoint only the ones going below 0)
+void fvalues_sub_run(fvalues_t*, size_t start, size_t size, unsigned decrement, bool disjoint);
+//adds the increment to the values in [start, start + size), without widening the array
+void fvalues_add_run(fvalues_t*, size_t start, size_t size, unsigned increment);
+unsigned fvalues_max_run(fvalues_t*, size_t start, size_t size); //max value in [start, start + size)
+//min value greater than 0 in [start, start + size), sets zeros if there is a 0 not don't care
+unsigned fvalues_min_run(fvalues_t*, size_t start, size_t size, bool* zeros);
+bool fvalues_dont_care_run(fvalues_t*, size_t start, size_t size); //true if all are don't cares
+void fvalues_destroy(fvalues_t*); //frees the memory used
+
+//returns the i-th value, 0 for a don't care
+static inline unsigned fvalues_get(const fvalues_t* v, size_t i){
+    switch(v -> width){
+        case 1:
+            return ((const uint8_t*) v -> data)[i];
+        case 2:
+            return ((const uint16_t*) v -> data)[i];
+        default:
+            return ((const uint32_t*) v -> data)[i];
+    }
+}
+
+//returns true if the i-th value is a don't care
+static inline bool fvalues_is_dont_care(const fvalues_t* v, size_t i){
+    return (v -> dont_cares[i / CWORD_BITS] >> (i % CWORD_BITS)) & 1;
+}
+
+#endif //DSOPP_SYNTHESIS_FVALUES_H
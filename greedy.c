@@ -0,0 +1,456 @@
+#include <string.h>
+#include "greedy.h"
+#include "utils.h"
+
+#define GREEDY_INIT_SIZE 16
+
+//internal functions
+bool greedy_add(greedy_t* g, cube_t c);
+bool greedy_grow(greedy_t* g);
+bool greedy_index(greedy_t* g, size_t id);
+void greedy_scan(greedy_t* g, size_t id);
+size_t greedy_rescan(greedy_t* g, cube_t changed);
+size_t greedy_mark(greedy_t* g, size_t id, size_t size);
+size_t greedy_intersecting(greedy_t* g, cube_t c, size_t size);
+void greedy_sort(greedy_t* g, size_t size);
+void greedy_unmark(greedy_t* g, size_t size);
+bool greedy_keep_primes(greedy_t* g, cube_t* primes, size_t size);
+bool greedy_covered(cube_t span, cube_t* primes, size_t size, cubeset_t* check);
+size_t greedy_ids(greedy_t* g);
+int greedy_position_compare(const void* a, const void* b);
+bool greedy_before(void* context, size_t a, size_t b);
+
+/**
+ * Creates the structure with the given implicants
+ * @param f The function, it is not copied and must be valid until greedy_destroy
+ * @param implicants The implicants, copied. Among the ones with the same max the first ones are chosen first,
+ *          until greedy_update_wprimes orders them as the primes
+ * @return A pointer to the structure
+ */
+greedy_t* greedy_create(fplus_t* f, implicants_t* implicants){
+    greedy_t* g;
+    MALLOC(g, sizeof(greedy_t), ;);
+    memset(g, 0, sizeof(greedy_t));
+    g -> f = f;
+    g -> max_length = implicants -> size > GREEDY_INIT_SIZE ? (size_t) implicants -> size : GREEDY_INIT_SIZE;
+    g -> key_variables = f -> variables < GREEDY_KEY_VARIABLES ? f -> variables : GREEDY_KEY_VARIABLES;
+    size_t buckets = (size_t) 1 << (2 * g -> key_variables);
+    MALLOC(g -> max, sizeof(unsigned) * g -> max_length, greedy_destroy(g));
+    MALLOC(g -> positives, sizeof(size_t) * g -> max_length, greedy_destroy(g));
+    MALLOC(g -> span, sizeof(cube_t) * g -> max_length, greedy_destroy(g));
+    MALLOC(g -> order, sizeof(size_t) * g -> max_length, greedy_destroy(g));
+    MALLOC(g -> was_prime, sizeof(bool) * g -> max_length, greedy_destroy(g));
+    MALLOC(g -> marked, sizeof(bool) * g -> max_length, greedy_destroy(g));
+    MALLOC(g -> ids, sizeof(size_t) * g -> max_length, greedy_destroy(g));
+    MALLOC(g -> added, sizeof(size_t) * g -> max_length, greedy_destroy(g));
+    MALLOC(g -> buckets, sizeof(greedy_bucket_t) * buckets, greedy_destroy(g));
+    memset(g -> marked, 0, sizeof(bool) * g -> max_length);
+    memset(g -> buckets, 0, sizeof(greedy_bucket_t) * buckets);
+    g -> cubes = cubeset_create(g -> max_length);
+    g -> heap = heap_create(g -> max_length, greedy_before, g);
+    if(g -> cubes == NULL || g -> heap == NULL){
+        greedy_destroy(g);
+        return NULL;
+    }
+    for(int i = 0; i < implicants -> size; i++){
+        if(!greedy_add(g, implicants -> cubes[i])){
+            greedy_destroy(g);
+            return NULL;
+        }
+    }
+    return g;
+}
+
+/**
+ * Adds the implicant after the ones already added, unless it is already there
+ * @return false on error
+ */
+bool greedy_add(greedy_t* g, cube_t c){
+    long id = cubeset_index_of(g -> cubes, c);
+    if(id < 0){
+        if(cubeset_length(g -> cubes) == g -> max_length && !greedy_grow(g))
+            return false;
+        if(!cubeset_add(g -> cubes, c))
+            return false;
+        id = (long) cubeset_length(g -> cubes) - 1;
+        if(!greedy_index(g, (size_t) id))
+            return false;
+    } else if(heap_contains(g -> heap, (size_t) id))
+        return true;
+    g -> order[id] = g -> next_order++;
+    g -> was_prime[id] = true;
+    greedy_scan(g, (size_t) id);
+    //an id is added at most once between two updates with the primes, since only they remove the ids
+    g -> added[g -> added_length++] = (size_t) id;
+    return heap_push(g -> heap, (size_t) id);
+}
+
+/**
+ * Doubles the size of the arrays of the implicants
+ * @return false on error
+ */
+bool greedy_grow(greedy_t* g){
+    size_t new_size = g -> max_length * 2;
+    REALLOC(g -> max, sizeof(unsigned) * new_size, return false);
+    REALLOC(g -> positives, sizeof(size_t) * new_size, return false);
+    REALLOC(g -> span, sizeof(cube_t) * new_size, return false);
+    REALLOC(g -> order, sizeof(size_t) * new_size, return false);
+    REALLOC(g -> was_prime, sizeof(bool) * new_size, return false);
+    REALLOC(g -> marked, sizeof(bool) * new_size, return false);
+    REALLOC(g -> ids, sizeof(size_t) * new_size, return false);
+    REALLOC(g -> added, sizeof(size_t) * new_size, return false);
+    memset(g -> marked + g -> max_length, 0, sizeof(bool) * (new_size - g -> max_length));
+    g -> max_length = new_size;
+    return true;
+}
+
+/**
+ * @return The position of the bucket of the cube: its care and value bits on the key variables,
+ *      which are the last ones (the lowest bits)
+ */
+static inline size_t greedy_key(greedy_t* g, cube_t c){
+    cword_t care = c.care & CUBE_MASK(g -> key_variables);
+    return (size_t) ((care << g -> key_variables) | (c.value & care));
+}
+
+/**
+ * Adds the new implicant to the bucket of its key
+ * @return false on error
+ */
+bool greedy_index(greedy_t* g, size_t id){
+    greedy_bucket_t* bucket = g -> buckets + greedy_key(g, cubeset_as_array(g -> cubes, NULL)[id]);
+    if(bucket -> length == bucket -> max_length){
+        size_t new_max = bucket -> max_length == 0 ? GREEDY_INIT_SIZE : bucket -> max_length * 2;
+        REALLOC(bucket -> ids, sizeof(size_t) * new_max, return false);
+        bucket -> max_length = new_max;
+    }
+    bucket -> ids[bucket -> length++] = id;
+    return true;
+}
+
+/**
+ * Reads again the values of the points covered by the implicant
+ */
+void greedy_scan(greedy_t* g, size_t id){
+    cube_t* cubes = cubeset_as_array(g -> cubes, NULL);
+    g -> max[id] = fplus_cube_span(g -> f, cubes[id], g -> span + id, g -> positives + id);
+}
+
+/**
+ * Finds the implicant with the lowest max greater than 0, the first one by order among the ones with the same max
+ * @param g The structure
+ * @param chosen Will store the implicant, it is not removed
+ * @param max Will store its max
+ * @return false if all the implicants left have max 0
+ */
+bool greedy_choose(greedy_t* g, cube_t* chosen, unsigned* max){
+    size_t top = heap_top(g -> heap);
+    if(top == HEAP_ABSENT || g -> max[top] == 0)
+        return false;
+    *chosen = cubeset_as_array(g -> cubes, NULL)[top];
+    *max = g -> max[top];
+    return true;
+}
+
+/**
+ * Updates the implicants intersecting the cube, after the values of the points it covers decreased
+ * @param g The structure
+ * @param changed A cube covering all the points changed
+ */
+void greedy_update(greedy_t* g, cube_t changed){
+    greedy_unmark(g, greedy_rescan(g, changed));
+}
+
+/**
+ * Scans again the implicants left intersecting the cube, they are left marked in the ids array
+ * @return Their number
+ */
+size_t greedy_rescan(greedy_t* g, cube_t changed){
+    size_t size = greedy_intersecting(g, changed, 0);
+    //the heap changes while updating, so the implicants are taken first in its order
+    greedy_sort(g, size);
+    for(size_t i = 0; i < size; i++){
+        greedy_scan(g, g -> ids[i]);
+        heap_update(g -> heap, g -> ids[i]);
+    }
+    return size;
+}
+
+/**
+ * Appends the implicant to the ids array and marks it, if it is left and not already marked
+ * @param size The number of ids in the array
+ * @return The new number of ids
+ */
+size_t greedy_mark(greedy_t* g, size_t id, size_t size){
+    if(!g -> marked[id] && heap_contains(g -> heap, id)){
+        g -> marked[id] = true;
+        g -> ids[size++] = id;
+    }
+    return size;
+}
+
+/**
+ * Marks the implicants left intersecting the cube, visiting only the buckets whose key has no literal
+ * opposite to one of the cube: for each care of the key, the values of the variables fixed by the cube
+ * are the ones of the cube and the others take all the values
+ * @param size The number of ids already in the array
+ * @return The new number of ids
+ */
+size_t greedy_intersecting(greedy_t* g, cube_t c, size_t size){
+    cube_t* cubes = cubeset_as_array(g -> cubes, NULL);
+    unsigned k = g -> key_variables;
+    cword_t mask = CUBE_MASK(k);
+    cword_t care = c.care & mask;
+    cword_t value = c.value & care;
+    cword_t key_care = 0;
+    do{
+        cword_t free_vars = key_care & ~care;
+        cword_t subset = 0;
+        do{
+            greedy_bucket_t* bucket = g -> buckets + (size_t) ((key_care << k) | (value & key_care) | subset);
+            for(size_t i = 0; i < bucket -> length; i++){
+                if(cube_intersects(cubes[bucket -> ids[i]], c))
+                    size = greedy_mark(g, bucket -> ids[i], size);
+            }
+            subset = (subset - free_vars) & free_vars;
+        }while(subset != 0);
+        key_care = (key_care - mask) & mask;
+    }while(key_care != 0);
+    return size;
+}
+
+/**
+ * Orders the first ids of the array as they are in the heap
+ */
+void greedy_sort(greedy_t* g, size_t size){
+    for(size_t i = 0; i < size; i++)
+        g -> ids[i] = g -> heap -> positions[g -> ids[i]];
+    qsort(g -> ids, size, sizeof(size_t), greedy_position_compare);
+    for(size_t i = 0; i < size; i++)
+        g -> ids[i] = g -> heap -> items[g -> ids[i]];
+}
+
+/**
+ * Clears the marks of the first ids of the array
+ */
+void greedy_unmark(greedy_t* g, size_t size){
+    for(size_t i = 0; i < size; i++)
+        g -> marked[g -> ids[i]] = false;
+}
+
+/**
+ * Same as greedy_update, then follows the primes updated by primes_update on the same cube: as done by
+ * remove_implicant_duplicates, the implicants whose points greater than 0 are all covered by a prime (or have
+ * none) are removed and the new primes are added. A prime covers itself, so the primes are always kept,
+ * ordered as in the primes set. An implicant that was already not prime at the last update and does not
+ * intersect the cube has the same points as then, so it is checked only against the primes that may be new.
+ * Only the implicants that may change are checked: the ones intersecting the cube, the ones added since the
+ * last update, the ones checked by primes_update, the primes moved in the primes set and the implicants
+ * intersecting a prime checked by primes_update (the only ones it may cover)
+ * @param g The structure
+ * @param changed A cube covering all the points changed
+ * @param p The primes of the function, already updated
+ */
+void greedy_update_wprimes(greedy_t* g, cube_t changed, primes_t* p){
+    size_t size = greedy_rescan(g, changed);
+
+    //the primes changed are among the cubes checked by primes_update
+    size_t dirty_size, primes_size;
+    cube_t* dirty = cubeset_as_array(p -> dirty, &dirty_size);
+    cube_t* primes = cubeset_as_array(p -> primes, &primes_size);
+    for(size_t i = 0; i < dirty_size; i++){
+        if(cubeset_contains(p -> primes, dirty[i]))
+            greedy_add(g, dirty[i]);
+    }
+    if(primes_size == 0){
+        greedy_unmark(g, size);
+        return;
+    }
+
+    for(size_t i = 0; i < g -> added_length; i++)
+        size = greedy_mark(g, g -> added[i], size);
+    for(size_t i = 0; i < dirty_size; i++){
+        long id = cubeset_index_of(g -> cubes, dirty[i]);
+        if(id >= 0)
+            size = greedy_mark(g, (size_t) id, size);
+        if(cubeset_contains(p -> primes, dirty[i]))
+            size = greedy_intersecting(g, dirty[i], size);
+    }
+    for(size_t i = 0; i < primes_size; i++){
+        if(i < g -> primes_length && primes[i].care == g -> primes[i].care &&
+            primes[i].value == g -> primes[i].value)
+            continue;
+        long id = cubeset_index_of(g -> cubes, primes[i]);
+        if(id >= 0)
+            size = greedy_mark(g, (size_t) id, size);
+    }
+    greedy_sort(g, size);
+    greedy_unmark(g, size);
+    g -> added_length = 0;
+    if(!greedy_keep_primes(g, primes, primes_size))
+        g -> primes_length = 0; //all the primes are checked at the next update
+
+    cube_t* cubes = cubeset_as_array(g -> cubes, NULL);
+    for(size_t i = 0; i < size; i++){
+        size_t id = g -> ids[i];
+        long position = cubeset_index_of(p -> primes, cubes[id]);
+        if(position >= 0){
+            if(!g -> was_prime[id] || g -> order[id] != (size_t) position){
+                g -> was_prime[id] = true;
+                g -> order[id] = (size_t) position;
+                heap_update(g -> heap, id);
+            }
+            continue;
+        }
+        bool covered = g -> positives[id] == 0;
+        if(!covered && (g -> was_prime[id] || cube_intersects(cubes[id], changed)))
+            covered = greedy_covered(g -> span[id], primes, primes_size, NULL);
+        else if(!covered)
+            covered = greedy_covered(g -> span[id], dirty, dirty_size, p -> primes);
+        if(covered)
+            heap_remove(g -> heap, id);
+        else if(g -> was_prime[id]){
+            g -> was_prime[id] = false;
+            g -> order[id] = g -> next_order++;
+            heap_update(g -> heap, id);
+        }
+    }
+}
+
+/**
+ * Copies the primes, to find the ones moved at the next update
+ * @return false on error
+ */
+bool greedy_keep_primes(greedy_t* g, cube_t* primes, size_t size){
+    if(size > g -> primes_max){
+        REALLOC(g -> primes, sizeof(cube_t) * size, return false);
+        g -> primes_max = size;
+    }
+    memcpy(g -> primes, primes, sizeof(cube_t) * size);
+    g -> primes_length = size;
+    return true;
+}
+
+/**
+ * @param span The cube to cover
+ * @param primes The cubes that may cover it
+ * @param size The size of the above array
+ * @param check If not NULL, only the cubes in this set are considered
+ * @return true if a cube covers span
+ */
+bool greedy_covered(cube_t span, cube_t* primes, size_t size, cubeset_t* check){
+    for(size_t i = 0; i < size; i++){
+        if(cube_contains(primes[i], span) && (check == NULL || cubeset_contains(check, primes[i])))
+            return true;
+    }
+    return false;
+}
+
+/**
+ * Removes the implicants covering only don't care points of the function. As it was done on the implicants
+ * array, the last implicant takes the place of a removed one, so the order of the implicants left changes
+ * @param g The structure
+ * @param f The function checked, usually not the one of the structure
+ */
+void greedy_remove_dont_cares(greedy_t* g, fplus_t* f){
+    cube_t* cubes = cubeset_as_array(g -> cubes, NULL);
+    //the ids left by order, the orders are unique if the primes were never followed
+    size_t* by_order = calloc(g -> next_order, sizeof(size_t));
+    if(by_order == NULL)
+        return;
+    size_t size = greedy_ids(g);
+    for(size_t i = 0; i < g -> next_order; i++)
+        by_order[i] = HEAP_ABSENT;
+    for(size_t i = 0; i < size; i++)
+        by_order[g -> order[g -> ids[i]]] = g -> ids[i];
+    size = 0;
+    for(size_t i = 0; i < g -> next_order; i++){
+        if(by_order[i] != HEAP_ABSENT)
+            g -> ids[size++] = by_order[i];
+    }
+    FREE(by_order);
+
+    size_t removed = 0;
+    size_t i = 0;
+    while(i < size - removed){
+        if(fplus_cube_dont_care(f, cubes[g -> ids[i]])){
+            removed++;
+            g -> ids[i] = g -> ids[size - removed];
+        } else
+            i++;
+    }
+    size -= removed;
+
+    heap_clear(g -> heap);
+    for(i = 0; i < size; i++)
+        g -> order[g -> ids[i]] = i;
+    g -> next_order = size;
+    for(i = 0; i < size; i++)
+        heap_push(g -> heap, g -> ids[i]);
+}
+
+/**
+ * Copies the ids of the implicants left in the ids array
+ * @return Their number
+ */
+size_t greedy_ids(greedy_t* g){
+    size_t size = heap_length(g -> heap);
+    memcpy(g -> ids, g -> heap -> items, sizeof(size_t) * size);
+    return size;
+}
+
+/**
+ * Orders the positions ascending
+ */
+int greedy_position_compare(const void* a, const void* b){
+    size_t x = *(const size_t*) a;
+    size_t y = *(const size_t*) b;
+    return x < y ? -1 : x > y;
+}
+
+/**
+ * Orders the implicants by max (lower first, 0 last), then the ones no longer prime, then by order
+ * @param context The structure
+ * @return true if the implicant a has to be chosen before b
+ */
+bool greedy_before(void* context, size_t a, size_t b){
+    greedy_t* g = context;
+    if(g -> max[a] != g -> max[b])
+        return g -> max[b] == 0 || (g -> max[a] != 0 && g -> max[a] < g -> max[b]);
+    if(g -> was_prime[a] != g -> was_prime[b])
+        return g -> was_prime[b];
+    return g -> order[a] < g -> order[b];
+}
+
+/**
+ * @return The number of implicants left
+ */
+size_t greedy_length(greedy_t* g){
+    NULL_CHECK(g);
+    return heap_length(g -> heap);
+}
+
+/**
+ * Frees the memory used, the function is not destroyed
+ */
+void greedy_destroy(greedy_t* g){
+    if(g != NULL){
+        cubeset_destroy(g -> cubes);
+        FREE(g -> max);
+        FREE(g -> positives);
+        FREE(g -> span);
+        FREE(g -> order);
+        FREE(g -> was_prime);
+        FREE(g -> marked);
+        FREE(g -> ids);
+        FREE(g -> added);
+        FREE(g -> primes);
+        if(g -> buckets != NULL){
+            for(size_t i = 0; i < (size_t) 1 << (2 * g -> key_variables); i++)
+                FREE(g -> buckets[i].ids);
+            FREE(g -> buckets);
+        }
+        heap_destroy(g -> heap);
+        FREE(g);
+    }
+}
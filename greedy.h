@@ -0,0 +1,65 @@
+/*
+ * Library keeping the implicants the greedy phase of the sopp syntheses chooses from. For each implicant it keeps
+ * the max output of the points covered, the number of them greater than 0 and the smallest cube covering those,
+ * and the implicants are in a heap by max, so that the one with the lowest max greater than 0 is found at once.
+ * When the values of some points decrease only the implicants intersecting them are scanned again: the implicants
+ * are indexed by their literals on the last GREEDY_KEY_VARIABLES variables, so only the ones whose literals there
+ * are compatible with the cube changed are visited.
+ * Following the primes, the implicants whose points greater than 0 are all covered by a single prime are
+ * removed and the new primes are added (as remove_implicant_duplicates does with the whole arrays).
+ * Among the implicants with the same max, the ones no longer prime come first and the primes follow in their
+ * order in the primes set, which is where remove_implicant_duplicates put them in the array
+ */
+
+#ifndef DSOPP_SYNTHESIS_GREEDY_H
+#define DSOPP_SYNTHESIS_GREEDY_H
+
+#include <stddef.h>
+#include "bool_plus.h"
+#include "cubeset.h"
+#include "heap.h"
+#include "primes.h"
+
+#define GREEDY_KEY_VARIABLES 6
+
+typedef struct{
+    size_t* ids; //the ids of the implicants with this key
+    size_t length; //number of ids
+    size_t max_length; //size of the above array
+}greedy_bucket_t;
+
+typedef struct{
+    fplus_t* f; //the function, its values are read at each update
+    cubeset_t* cubes; //all the implicants ever added, the position of an implicant is its id
+    unsigned* max; //max output of the points covered by each implicant
+    size_t* positives; //number of points with output greater than 0 covered by each implicant
+    cube_t* span; //smallest cube covering the points with output greater than 0 of each implicant
+    size_t* order; //among the implicants with the same max the one with the lowest order is chosen
+    bool* was_prime; //true if the implicant was prime at the last update, or it was never checked
+    size_t max_length; //size of the above arrays
+    size_t next_order; //order of the next implicant added
+    bool* marked; //true if the implicant is among the ids to update
+    size_t* ids; //ids of the implicants to update, of size max_length
+    size_t* added; //ids of the implicants added since the last update with the primes, of size max_length
+    size_t added_length; //number of the above ids
+    cube_t* primes; //the primes at the last update with the primes, in their order
+    size_t primes_length; //number of the above primes
+    size_t primes_max; //size of the above array
+    unsigned key_variables; //number of the variables of the keys
+    greedy_bucket_t* buckets; //the implicants by their literals on the key variables
+    heap_t* heap; //ids of the implicants left, by max (0 last) then by order
+}greedy_t;
+
+//creates the structure, among the implicants with the same max the first ones are chosen first (until reordered)
+greedy_t* greedy_create(fplus_t*, implicants_t*);
+//sets the implicant with the lowest max greater than 0 and its max, returns false if there is none
+bool greedy_choose(greedy_t*, cube_t* chosen, unsigned* max);
+void greedy_update(greedy_t*, cube_t changed); //updates the implicants after the values in the cube decreased
+//same as above, then removes the implicants covered by a prime and adds the new primes (after primes_update)
+void greedy_update_wprimes(greedy_t*, cube_t changed, primes_t*);
+//removes the implicants covering only don't cares of the function, as done on the implicants array
+void greedy_remove_dont_cares(greedy_t*, fplus_t*);
+size_t greedy_length(greedy_t*); //returns the number of implicants left
+void greedy_destroy(greedy_t*); //frees the memory used, the function is not destroyed
+
+#endif //DSOPP_SYNTHESIS_GREEDY_H
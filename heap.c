@@ -0,0 +1,182 @@
+#include "heap.h"
+#include "utils.h"
+
+//internal functions
+bool heap_grow(heap_t* heap, size_t id);
+void heap_place(heap_t* heap, size_t position, size_t id);
+void heap_sift_up(heap_t* heap, size_t position);
+void heap_sift_down(heap_t* heap, size_t position);
+
+/**
+ * Creates an empty heap
+ * @param expected_ids The expected max id plus one, the heap grows if exceeded
+ * @param before The order of the ids
+ * @param context Passed to before
+ * @return A pointer to the heap
+ */
+heap_t* heap_create(size_t expected_ids, heap_before_t before, void* context){
+    heap_t* heap;
+    MALLOC(heap, sizeof(heap_t), ;);
+    heap -> max_id = expected_ids > HEAP_INIT_SIZE ? expected_ids : HEAP_INIT_SIZE;
+    heap -> length = 0;
+    heap -> before = before;
+    heap -> context = context;
+    MALLOC(heap -> items, sizeof(size_t) * heap -> max_id, FREE(heap));
+    MALLOC(heap -> positions, sizeof(size_t) * heap -> max_id, FREE(heap -> items); FREE(heap));
+    for(size_t i = 0; i < heap -> max_id; i++)
+        heap -> positions[i] = HEAP_ABSENT;
+    return heap;
+}
+
+/**
+ * Grows the heap to hold the given id
+ * @return false on error
+ */
+bool heap_grow(heap_t* heap, size_t id){
+    size_t new_size = heap -> max_id;
+    while(new_size <= id)
+        new_size *= 2;
+    REALLOC(heap -> items, sizeof(size_t) * new_size, return false);
+    REALLOC(heap -> positions, sizeof(size_t) * new_size, return false);
+    for(size_t i = heap -> max_id; i < new_size; i++)
+        heap -> positions[i] = HEAP_ABSENT;
+    heap -> max_id = new_size;
+    return true;
+}
+
+/**
+ * Adds the id to the heap
+ * @param heap The heap
+ * @param id The id, its key has to be already set
+ * @return false if the id was already in the heap or on error
+ */
+bool heap_push(heap_t* heap, size_t id){
+    if(id >= heap -> max_id && !heap_grow(heap, id))
+        return false;
+    if(heap -> positions[id] != HEAP_ABSENT)
+        return false;
+    heap_place(heap, heap -> length++, id);
+    heap_sift_up(heap, heap -> length - 1);
+    return true;
+}
+
+/**
+ * @return The first id of the heap, HEAP_ABSENT if it is empty
+ */
+size_t heap_top(heap_t* heap){
+    return heap -> length > 0 ? heap -> items[0] : HEAP_ABSENT;
+}
+
+/**
+ * Removes the first id of the heap
+ * @return The id removed, HEAP_ABSENT if the heap is empty
+ */
+size_t heap_pop(heap_t* heap){
+    size_t top = heap_top(heap);
+    if(top != HEAP_ABSENT)
+        heap_remove(heap, top);
+    return top;
+}
+
+/**
+ * Removes the id from the heap, the last one takes its place
+ * @return true if the id was in the heap
+ */
+bool heap_remove(heap_t* heap, size_t id){
+    if(!heap_contains(heap, id))
+        return false;
+    size_t position = heap -> positions[id];
+    heap -> positions[id] = HEAP_ABSENT;
+    size_t last = heap -> items[--heap -> length];
+    if(position < heap -> length){
+        heap_place(heap, position, last);
+        heap_update(heap, last);
+    }
+    return true;
+}
+
+/**
+ * Moves the id to its place after its key changed, in any direction
+ */
+void heap_update(heap_t* heap, size_t id){
+    if(!heap_contains(heap, id))
+        return;
+    size_t position = heap -> positions[id];
+    heap_sift_up(heap, position);
+    if(heap -> positions[id] == position)
+        heap_sift_down(heap, position);
+}
+
+/**
+ * @return true if the id is in the heap
+ */
+bool heap_contains(heap_t* heap, size_t id){
+    return id < heap -> max_id && heap -> positions[id] != HEAP_ABSENT;
+}
+
+/**
+ * @return The number of ids in the heap
+ */
+size_t heap_length(heap_t* heap){
+    return heap -> length;
+}
+
+/**
+ * Puts the id in the given position of the heap
+ */
+void heap_place(heap_t* heap, size_t position, size_t id){
+    heap -> items[position] = id;
+    heap -> positions[id] = position;
+}
+
+/**
+ * Moves the id in the given position toward the top while it comes before its parent
+ */
+void heap_sift_up(heap_t* heap, size_t position){
+    size_t id = heap -> items[position];
+    while(position > 0){
+        size_t parent = (position - 1) / 2;
+        if(!heap -> before(heap -> context, id, heap -> items[parent]))
+            break;
+        heap_place(heap, position, heap -> items[parent]);
+        position = parent;
+    }
+    heap_place(heap, position, id);
+}
+
+/**
+ * Moves the id in the given position toward the bottom while a child comes before it
+ */
+void heap_sift_down(heap_t* heap, size_t position){
+    size_t id = heap -> items[position];
+    while(2 * position + 1 < heap -> length){
+        size_t child = 2 * position + 1;
+        if(child + 1 < heap -> length && heap -> before(heap -> context, heap -> items[child + 1], heap -> items[child]))
+            child++;
+        if(!heap -> before(heap -> context, heap -> items[child], id))
+            break;
+        heap_place(heap, position, heap -> items[child]);
+        position = child;
+    }
+    heap_place(heap, position, id);
+}
+
+/**
+ * Removes all the ids from the heap, keeping the memory
+ */
+void heap_clear(heap_t* heap){
+    for(size_t i = 0; i < heap -> length; i++)
+        heap -> positions[heap -> items[i]] = HEAP_ABSENT;
+    heap -> length = 0;
+}
+
+/**
+ * Frees the memory used by the heap
+ */
+void heap_destroy(heap_t* heap){
+    if(heap != NULL){
+        FREE(heap -> items);
+        FREE(heap -> positions);
+        FREE(heap);
+    }
+}
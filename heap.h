@@ -0,0 +1,42 @@
+/*
+ * Library implementing an indexed binary heap of ids (small naturals, each one in the heap at most once).
+ * The order is given by a function comparing two ids, so the keys live with the caller: after changing the key
+ * of an id in the heap, heap_update moves it to its new place. The position of each id is kept, so an id can be
+ * updated or removed in O(log n) without searching it
+ */
+
+#ifndef DSOPP_SYNTHESIS_HEAP_H
+#define DSOPP_SYNTHESIS_HEAP_H
+
+#include <stddef.h>
+#include "bool_utils.h"
+
+#define HEAP_INIT_SIZE 16
+
+//position of an id not in the heap, also returned by heap_top and heap_pop on an empty heap
+#define HEAP_ABSENT ((size_t) -1)
+
+//returns true if the id a has to be extracted before the id b
+typedef bool (*heap_before_t)(void* context, size_t a, size_t b);
+
+typedef struct{
+    size_t* items; //the ids in the heap, items[0] is the top
+    size_t length; //number of ids in the heap
+    size_t* positions; //position of each id in items, HEAP_ABSENT if not in the heap
+    size_t max_id; //size of the above arrays, the ids are lower
+    heap_before_t before; //the order of the ids
+    void* context; //passed to before
+}heap_t;
+
+heap_t* heap_create(size_t expected_ids, heap_before_t, void* context); //creates an empty heap
+bool heap_push(heap_t*, size_t id); //adds the id, returns false if it was already in the heap or on error
+size_t heap_top(heap_t*); //returns the first id, without removing it
+size_t heap_pop(heap_t*); //removes and returns the first id
+bool heap_remove(heap_t*, size_t id); //removes the id, returns true if it was in the heap
+void heap_update(heap_t*, size_t id); //moves the id after its key changed
+bool heap_contains(heap_t*, size_t id); //returns true if the id is in the heap
+size_t heap_length(heap_t*); //returns the number of ids
+void heap_clear(heap_t*); //removes all the ids keeping the memory
+void heap_destroy(heap_t*); //frees the memory used by the heap
+
+#endif //DSOPP_SYNTHESIS_HEAP_H
@@ -0,0 +1,227 @@
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+#include "portfolio.h"
+#include "exact.h"
+#include "utils.h"
+
+//state of a race, shared by the caller and the engines and freed by the last one leaving it
+typedef struct{
+    fplus_t* f; //copy of the function, the caller can destroy its own before the engines are done
+    bool dsopp; //true to synthesize dsopp forms
+    double max_seconds; //time given to the exact engine, 0 for no limit
+    long lower_bound; //no form can be lighter
+    sopp_t* best; //the lightest form found
+    long best_weight; //weight of above form
+    unsigned best_engine; //engine that found above form
+    bool proved; //true if the best form has been proved minimal
+    unsigned running; //engines not yet done
+    unsigned references; //engines not yet done plus the caller, until it returns
+    bool finished; //true when the caller returned, the forms found later are freed
+    budget_t budget; //cancelled when the caller returns, to stop the engines still running
+    pthread_mutex_t lock; //protects all the fields above but f
+    pthread_cond_t cond; //signaled when an engine is done
+}portfolio_t;
+
+//an engine started by the race
+typedef struct{
+    portfolio_t* p;
+    unsigned engine;
+}portfolio_job_t;
+
+//internal functions
+void* portfolio_worker(void* arg);
+bool portfolio_leave(portfolio_t* p);
+void portfolio_destroy(portfolio_t* p);
+
+/**
+ * Runs the given engines on the function, each on its own thread, and returns the lightest form found.
+ * Waits until all the engines are done, the deadline passes or a form reaches a lower bound of the weight
+ * (see portfolio.h). The engines still running are cancelled, the function is copied so that it can be
+ * destroyed by the caller before they stop
+ * @param f A fplus function
+ * @param engines The PORTFOLIO_* engines to run, 0 for PORTFOLIO_DEFAULT. PORTFOLIO_EXACT is ignored for dsopp
+ * @param dsopp true to synthesize a dsopp form, else a sopp form
+ * @param max_seconds Time after which the lightest form found is returned, 0 for no limit.
+ *          If no engine is done by then, they are cancelled and the first form completed is returned
+ * @return The lightest form found, with its weight and engine. The form is NULL in case of error
+ */
+portfolio_result_t portfolio_synthesis(fplus_t* f, unsigned engines, bool dsopp, double max_seconds){
+    portfolio_result_t result = {NULL, 0, 0, false};
+    if(engines == 0)
+        engines = PORTFOLIO_DEFAULT;
+    if(dsopp)
+        engines &= ~(unsigned) PORTFOLIO_EXACT;
+    if((engines & PORTFOLIO_ALL) == 0)
+        return result;
+
+    portfolio_t* p = calloc(1, sizeof(portfolio_t));
+    if(p == NULL)
+        return result;
+    p -> dsopp = dsopp;
+    p -> max_seconds = max_seconds;
+    if((p -> f = fplus_copy(f)) == NULL){
+        FREE(p);
+        return result;
+    }
+    //each point needs its own value, so no form is lighter than the max one
+    p -> lower_bound = fplus_cube_max(f, (cube_t) {0, 0});
+    p -> references = 1;
+    budget_init(&p -> budget, 0);
+    pthread_mutex_init(&p -> lock, NULL);
+    pthread_condattr_t attributes;
+    pthread_condattr_init(&attributes);
+    pthread_condattr_setclock(&attributes, CLOCK_MONOTONIC);
+    pthread_cond_init(&p -> cond, &attributes);
+    pthread_condattr_destroy(&attributes);
+
+    struct timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    if(max_seconds > 0){
+        double end = (double) deadline.tv_sec + (double) deadline.tv_nsec / 1e9 + max_seconds;
+        deadline.tv_sec = (time_t) end;
+        deadline.tv_nsec = (long) ((end - (double) deadline.tv_sec) * 1e9);
+    }
+
+    pthread_attr_t detached;
+    pthread_attr_init(&detached);
+    pthread_attr_setdetachstate(&detached, PTHREAD_CREATE_DETACHED);
+    for(unsigned i = 0; i < PORTFOLIO_ENGINES; i++){
+        unsigned engine = 1u << i;
+        if((engines & engine) == 0)
+            continue;
+        portfolio_job_t* job = malloc(sizeof(portfolio_job_t));
+        if(job == NULL)
+            continue;
+        job -> p = p;
+        job -> engine = engine;
+        pthread_mutex_lock(&p -> lock);
+        p -> running++;
+        p -> references++;
+        pthread_mutex_unlock(&p -> lock);
+        pthread_t id;
+        //without a thread the engine runs on the caller's one
+        if(pthread_create(&id, &detached, portfolio_worker, job) != 0)
+            portfolio_worker(job);
+    }
+    pthread_attr_destroy(&detached);
+
+    pthread_mutex_lock(&p -> lock);
+    bool timeout = false;
+    while(p -> running > 0 && !p -> proved && (p -> best == NULL || p -> best_weight > p -> lower_bound)){
+        if(timeout && p -> best != NULL)
+            break;
+        if(max_seconds > 0 && !timeout){
+            //without a form by the deadline, the engines are stopped to complete the ones they found
+            if((timeout = pthread_cond_timedwait(&p -> cond, &p -> lock, &deadline) == ETIMEDOUT))
+                budget_cancel(&p -> budget);
+        } else
+            pthread_cond_wait(&p -> cond, &p -> lock);
+    }
+    result.form = p -> best;
+    result.weight = p -> best_weight;
+    result.engine = p -> best_engine;
+    result.complete = p -> running == 0 || p -> proved ||
+            (p -> best != NULL && p -> best_weight <= p -> lower_bound);
+    p -> best = NULL;
+    p -> finished = true;
+    budget_cancel(&p -> budget);
+    pthread_mutex_unlock(&p -> lock);
+    if(portfolio_leave(p))
+        portfolio_destroy(p);
+    return result;
+}
+
+/**
+ * Runs a single engine on the function
+ * @param f A fplus function
+ * @param engine One of PORTFOLIO_*
+ * @param dsopp true to synthesize a dsopp form, else a sopp form (PORTFOLIO_EXACT has only the latter)
+ * @param max_seconds Time given to the exact engine, 0 for no limit
+ * @param budget The budget of the engines that check one, NULL for no limit
+ * @param optimal Will store true if the form is proved minimal
+ * @return The form found, NULL on error
+ */
+sopp_t* portfolio_engine(fplus_t* f, unsigned engine, bool dsopp, double max_seconds, budget_t* budget,
+                         bool* optimal){
+    *optimal = false;
+    switch(engine){
+        case PORTFOLIO_GREEDY:
+            return dsopp ? dsopp_synthesis_wbudget(f, budget) : sopp_synthesis_wbudget(f, budget);
+        case PORTFOLIO_EXPERIMENTAL:
+            return dsopp ? dsopp_synthesis_wexperimental_wbudget(f, budget) :
+                    sopp_synthesis_experimental_wbudget(f, budget);
+        case PORTFOLIO_HEURISTIC:
+            return dsopp ? dsopp_synthesis_wheuristic_wbudget(f, budget) : sopp_synthesis_heuristic_wbudget(f, budget);
+        case PORTFOLIO_EXACT: {
+            if(dsopp)
+                return NULL;
+            exact_t* e;
+            NULL_CHECK(e = exact_create(f, budget));
+            *optimal = exact_search(e, 1, 0, max_seconds, budget);
+            sopp_t* form = exact_sopp(e);
+            exact_destroy(e);
+            return form;
+        }
+        default:
+            return NULL;
+    }
+}
+
+/**
+ * Runs an engine and keeps its form if it is the lightest, frees the race if it is the last one leaving it
+ * @param arg The portfolio_job_t of the engine, freed
+ * @return NULL
+ */
+void* portfolio_worker(void* arg){
+    portfolio_job_t* job = arg;
+    portfolio_t* p = job -> p;
+    unsigned engine = job -> engine;
+    FREE(job);
+
+    bool optimal;
+    sopp_t* form = portfolio_engine(p -> f, engine, p -> dsopp, p -> max_seconds, &p -> budget, &optimal);
+    long weight = form != NULL ? sopp_weights_sum(form) : 0;
+
+    pthread_mutex_lock(&p -> lock);
+    if(form != NULL && !p -> finished && (p -> best == NULL || weight < p -> best_weight)){
+        sopp_t* previous = p -> best;
+        p -> best = form;
+        p -> best_weight = weight;
+        p -> best_engine = engine;
+        form = previous;
+    }
+    //no form is lighter than a minimal one, even if another engine found it first
+    if(optimal && !p -> finished)
+        p -> proved = true;
+    p -> running--;
+    pthread_cond_signal(&p -> cond);
+    pthread_mutex_unlock(&p -> lock);
+
+    sopp_destroy(form);
+    if(portfolio_leave(p))
+        portfolio_destroy(p);
+    return NULL;
+}
+
+/**
+ * Drops a reference to the race
+ * @return true if it was the last one, the race has to be freed
+ */
+bool portfolio_leave(portfolio_t* p){
+    pthread_mutex_lock(&p -> lock);
+    bool last = --p -> references == 0;
+    pthread_mutex_unlock(&p -> lock);
+    return last;
+}
+
+/**
+ * Frees the memory of a race left by everyone
+ */
+void portfolio_destroy(portfolio_t* p){
+    sopp_destroy(p -> best);
+    fplus_copy_destroy(p -> f);
+    pthread_mutex_destroy(&p -> lock);
+    pthread_cond_destroy(&p -> cond);
+    FREE(p);
+}
@@ -0,0 +1,30 @@
+/*
+ * Library implementing a portfolio synthesis: many engines run on the same function at the same time, each
+ * on its own thread, and the lightest form found is returned. The race ends when all the engines are done,
+ * when the deadline passes (after the first form is found) or when a form reaches a lower bound of the weight:
+ * the max output of the function, or the weight of a form the exact engine proved minimal.
+ * The engines still running are then cancelled through a budget (see budget.h): they stop at their next
+ * check, complete the form found so far and leave it to be freed, so that the engines losing the race stop
+ * soon after it ends instead of running to completion in the background. If no form is found by the deadline,
+ * the engines are cancelled at once and the first completed form is returned
+ */
+
+#ifndef DSOPP_SYNTHESIS_PORTFOLIO_H
+#define DSOPP_SYNTHESIS_PORTFOLIO_H
+
+#include "bool_plus.h"
+
+//the result of a portfolio synthesis
+typedef struct{
+    sopp_t* form; //the lightest form found, NULL on error
+    long weight; //sum of the coefficients of the form
+    unsigned engine; //the PORTFOLIO_* engine that found the form
+    bool complete; //true if all the engines were done or the lower bound was reached
+}portfolio_result_t;
+
+//runs the given engines (a mask of PORTFOLIO_*) and returns the lightest sopp or dsopp form
+portfolio_result_t portfolio_synthesis(fplus_t*, unsigned engines, bool dsopp, double max_seconds);
+//runs a single engine on the calling thread, sets optimal if the form is proved minimal
+sopp_t* portfolio_engine(fplus_t*, unsigned engine, bool dsopp, double max_seconds, budget_t*, bool* optimal);
+
+#endif //DSOPP_SYNTHESIS_PORTFOLIO_H
@@ -0,0 +1,151 @@
+#include "pqueue.h"
+#include "utils.h"
+
+#define PQUEUE_INIT_SIZE 16
+
+//internal functions
+bool pqueue_before(void* context, size_t a, size_t b);
+void pqueue_update(pqueue_t* queue, cube_t taken, fplus_t* f);
+
+/**
+ * Creates an empty queue
+ * @return A pointer to the queue
+ */
+pqueue_t* pqueue_create(){
+    pqueue_t* queue;
+    MALLOC(queue, sizeof(pqueue_t), ;);
+    queue -> length = 0;
+    queue -> max_length = PQUEUE_INIT_SIZE;
+    MALLOC(queue -> products, sizeof(productp_t*) * queue -> max_length, FREE(queue));
+    MALLOC(queue -> mins, sizeof(unsigned) * queue -> max_length, FREE(queue -> products); FREE(queue));
+    MALLOC(queue -> overlaps, sizeof(size_t) * queue -> max_length,
+            FREE(queue -> mins); FREE(queue -> products); FREE(queue));
+    queue -> heap = heap_create(queue -> max_length, pqueue_before, queue);
+    if(queue -> heap == NULL){
+        pqueue_destroy(queue);
+        return NULL;
+    }
+    return queue;
+}
+
+/**
+ * Adds the product to the queue. A product covering 0 points of the function is never taken, so it is not added
+ * @param queue The queue
+ * @param p The product to add
+ * @param f The function the products are taken from
+ * @return false on error
+ */
+bool pqueue_add(pqueue_t* queue, productp_t* p, fplus_t* f){
+    bool zeros;
+    unsigned min = fplus_cube_min(f, p -> b_product.cube, &zeros);
+    if(zeros)
+        return true;
+    if(queue -> length == queue -> max_length){
+        size_t new_size = queue -> max_length * 2;
+        REALLOC(queue -> products, sizeof(productp_t*) * new_size, return false);
+        REALLOC(queue -> mins, sizeof(unsigned) * new_size, return false);
+        REALLOC(queue -> overlaps, sizeof(size_t) * new_size, return false);
+        queue -> max_length = new_size;
+    }
+    queue -> products[queue -> length] = p;
+    queue -> mins[queue -> length] = min;
+    return heap_push(queue -> heap, queue -> length++);
+}
+
+/**
+ * Extracts the product with the max of the min outputs of the points it covers, with its min as coefficient
+ * the form stays below the function. Then updates the values of the function and the mins of the products left
+ * @param queue The queue
+ * @param value Sets the coefficient chosen
+ * @param f The function, the same for all the products added
+ * @return The product extracted, NULL if all the products left cover only don't care points
+ */
+productp_t* pqueue_max_product(pqueue_t* queue, int* value, fplus_t* f){
+    NULL_CHECK(queue);
+    size_t top = heap_top(queue -> heap);
+    //min is 0 if the product covers only don't care points
+    if(top == HEAP_ABSENT || queue -> mins[top] == 0)
+        return NULL;
+    heap_pop(queue -> heap);
+    productp_t* p = queue -> products[top];
+    *value = (int) queue -> mins[top];
+    fplus_cube_sub_dsopp(f, p -> b_product.cube, *value);
+    pqueue_update(queue, p -> b_product.cube, f);
+    return p;
+}
+
+/**
+ * Updates the mins of the products intersecting the cube just taken. Out of the cube the outputs did not change
+ * and in the cube they were only lowered, so the new min is the lowest of the old one and the min of the points
+ * in common (0 if they are all don't cares). The products now covering a 0 are removed
+ * @param queue The queue
+ * @param taken The cube of the product taken
+ * @param f The function, already updated
+ */
+void pqueue_update(pqueue_t* queue, cube_t taken, fplus_t* f){
+    heap_t* heap = queue -> heap;
+    size_t overlaps_size = 0;
+    //the heap changes while updating, so the products to update are found first
+    for(size_t i = 0; i < heap -> length; i++){
+        if(cube_intersects(queue -> products[heap -> items[i]] -> b_product.cube, taken))
+            queue -> overlaps[overlaps_size++] = heap -> items[i];
+    }
+    for(size_t i = 0; i < overlaps_size; i++){
+        size_t id = queue -> overlaps[i];
+        cube_t cube = queue -> products[id] -> b_product.cube;
+        cube_t common = {cube.care | taken.care, cube.value | taken.value};
+        bool zeros;
+        unsigned min = fplus_cube_min(f, common, &zeros);
+        if(zeros)
+            heap_remove(heap, id);
+        else if(min != 0 && min < queue -> mins[id]){
+            queue -> mins[id] = min;
+            heap_update(heap, id);
+        }
+    }
+}
+
+/**
+ * Orders the products by min (greater first, 0 last), then by fewer literals, then by the last added
+ * @param context The queue
+ * @return true if the product a has to be taken before b
+ */
+bool pqueue_before(void* context, size_t a, size_t b){
+    pqueue_t* queue = context;
+    if(queue -> mins[a] != queue -> mins[b])
+        return queue -> mins[a] > queue -> mins[b];
+    int literals_a = cube_literals(queue -> products[a] -> b_product.cube);
+    int literals_b = cube_literals(queue -> products[b] -> b_product.cube);
+    if(literals_a != literals_b)
+        return literals_a < literals_b;
+    return a > b;
+}
+
+/**
+ * @return The number of products in the queue
+ */
+size_t pqueue_length(pqueue_t* queue){
+    NULL_CHECK(queue);
+    return heap_length(queue -> heap);
+}
+
+/**
+ * Removes all the products from the queue, the products are not destroyed
+ */
+void pqueue_clear(pqueue_t* queue){
+    heap_clear(queue -> heap);
+    queue -> length = 0;
+}
+
+/**
+ * Frees all the memory used by the queue
+ */
+void pqueue_destroy(pqueue_t* queue){
+    if(queue != NULL){
+        heap_destroy(queue -> heap);
+        FREE(queue -> overlaps);
+        FREE(queue -> mins);
+        FREE(queue -> products);
+        FREE(queue);
+    }
+}
@@ -0,0 +1,32 @@
+/*
+ * A library implementing the queue of the products of a dsopp round, replacing the linked list that was scanned
+ * whole at each extraction. The products are in a heap by the min output (greater than 0) of the points they
+ * cover, then by fewer literals, then by the last added. The min of each product is kept up to date: taking
+ * a product lowers only the points of its cube, so only the products intersecting it are checked, on the
+ * points in common, and the ones now covering a 0 are removed at once
+ */
+
+#ifndef DSOPP_SYNTHESIS_PQUEUE_H
+#define DSOPP_SYNTHESIS_PQUEUE_H
+
+#include <stddef.h>
+#include "bool_plus.h"
+#include "heap.h"
+
+typedef struct{
+    productp_t** products; //the products added since the last clear, the position is their id in the heap
+    unsigned* mins; //min output greater than 0 of the points covered by each product, 0 if only don't cares
+    size_t length; //number of products added
+    size_t max_length; //size of the above arrays
+    size_t* overlaps; //ids of the products intersecting the one taken, of size max_length
+    heap_t* heap; //ids of the products still in the queue, the top is the next to take
+}pqueue_t;
+
+pqueue_t* pqueue_create(); //creates the queue
+bool pqueue_add(pqueue_t*, productp_t*, fplus_t*); //adds a product, unless it covers 0 points of the function
+productp_t* pqueue_max_product(pqueue_t*, int* value, fplus_t*); //extracts the product with the max min
+size_t pqueue_length(pqueue_t*); //number of products in the queue
+void pqueue_clear(pqueue_t*); //removes all the products
+void pqueue_destroy(pqueue_t*); //frees the memory
+
+#endif //DSOPP_SYNTHESIS_PQUEUE_H
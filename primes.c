@@ -0,0 +1,310 @@
+#include <string.h>
+#include "primes.h"
+#include "utils.h"
+
+//internal functions
+bool primes_joinable(primes_t* p, unsigned level, cube_t low, cube_t high);
+bool primes_generated(primes_t* p, unsigned level, cube_t c);
+bool primes_is_prime(primes_t* p, unsigned level, cube_t c);
+bool primes_candidates(primes_t* p, unsigned level, cube_t changed, size_t* size);
+bool primes_candidate_add(primes_t* p, unsigned level, cube_t c, size_t* size);
+int primes_index_compare(const void* a, const void* b);
+
+/**
+ * Runs Quine–McCluskey on the function keeping all the cubes generated
+ * @param f The function, it is not copied and must be valid until primes_destroy
+ * @return A pointer to the structure
+ */
+primes_t* primes_create(fplus_t* f){
+    return primes_create_wbudget(f, NULL);
+}
+
+/**
+ * Same as primes_create, the budget is checked every BUDGET_CHECK_STEPS cubes joined
+ * @param f The function, it is not copied and must be valid until primes_destroy
+ * @param budget The budget, NULL for no limit
+ * @return A pointer to the structure, NULL if the budget is over (or in case of error)
+ */
+primes_t* primes_create_wbudget(fplus_t* f, budget_t* budget){
+    primes_t* p;
+    MALLOC(p, sizeof(primes_t), ;);
+    p -> f = f;
+    MALLOC(p -> levels, sizeof(cubeset_t*) * (f -> variables + 1), FREE(p));
+    bool created = true;
+    for(unsigned l = 0; l <= f -> variables; l++)
+        created = (p -> levels[l] = cubeset_create(l == 0 ? f -> nz_size : 0)) != NULL && created;
+    p -> primes = cubeset_create(0);
+    p -> dirty = cubeset_create(0);
+    p -> affected = cubeset_create(0);
+    p -> candidates = NULL;
+    p -> candidates_max = 0;
+    if(!created || p -> primes == NULL || p -> dirty == NULL || p -> affected == NULL){
+        fprintf(stderr, "Error: null pointer\n");
+        primes_destroy(p);
+        return NULL;
+    }
+
+    for(size_t i = 0; i < f -> nz_size; i++)
+        cubeset_add(p -> levels[0], cube_of_point(f -> non_zeros[i], f -> variables));
+
+    //join each cube with its neighbours found setting one of its negative literals
+    for(unsigned l = 1; l <= f -> variables; l++){
+        size_t size;
+        cube_t* cubes = cubeset_as_array(p -> levels[l - 1], &size);
+        for(size_t i = 0; i < size; i++){
+            if(i % BUDGET_CHECK_STEPS == 0 && budget_over(budget)){
+                primes_destroy(p);
+                return NULL;
+            }
+            cword_t negatives = cubes[i].care & ~cubes[i].value;
+            while(negatives){
+                cword_t literal = negatives & -negatives;
+                negatives ^= literal;
+                cube_t neighbour = {cubes[i].care, cubes[i].value | literal};
+                if(cubeset_contains(p -> levels[l - 1], neighbour) &&
+                    primes_joinable(p, l - 1, cubes[i], neighbour)){
+                    cube_t join = {cubes[i].care & ~literal, cubes[i].value};
+                    cubeset_add(p -> levels[l], join);
+                }
+            }
+        }
+        if(size == 0)
+            break;
+    }
+
+    for(unsigned l = 0; l <= f -> variables; l++){
+        size_t size;
+        cube_t* cubes = cubeset_as_array(p -> levels[l], &size);
+        for(size_t i = 0; i < size; i++)
+            if(primes_is_prime(p, l, cubes[i]))
+                cubeset_add(p -> primes, cubes[i]);
+    }
+    return p;
+}
+
+/**
+ * Updates the implicants after the values of some points have been decreased (either become
+ * don't care or zero, as done by fplus_sub2value_sopp and fplus_sub2value_dsopp).
+ * Cubes can only stop being generated, and a cube stops only if one of its halves was removed
+ * (or, joining points, if one of them became a don't care). So from the lowest level only the
+ * points of the changed cube and then the supercubes of the cubes removed are checked, and the
+ * update stops at the first level with none removed. The primality of the neighbours of the
+ * removed cubes is then checked again
+ * @param p The implicants
+ * @param changed A cube covering all the points changed
+ */
+void primes_update(primes_t* p, cube_t changed){
+    unsigned variables = p -> f -> variables;
+    cubeset_clear(p -> dirty);
+    cubeset_clear(p -> affected);
+
+    for(unsigned l = 0; l <= variables; l++){
+        size_t size;
+        if(!primes_candidates(p, l, changed, &size))
+            return;
+        cubeset_clear(p -> affected);
+        if(size == 0)
+            break;
+        //from the last one, since a removal moves the last cube in place of the removed
+        qsort(p -> candidates, size, sizeof(size_t), primes_index_compare);
+        cube_t* cubes = cubeset_as_array(p -> levels[l], NULL);
+        for(size_t i = 0; i < size; i++){
+            if(i > 0 && p -> candidates[i] == p -> candidates[i - 1])
+                continue;
+            cube_t c = cubes[p -> candidates[i]];
+            if(primes_generated(p, l, c)){
+                if(l == 0){
+                    cubeset_add(p -> dirty, c); //may have become a don't care point
+                    if(fplus_is_dont_care(p -> f, c.value))
+                        cubeset_add(p -> affected, c); //its joins may be over
+                }
+                continue;
+            }
+            cubeset_remove(p -> levels[l], c);
+            cubeset_remove(p -> primes, c);
+            cubeset_add(p -> affected, c);
+            cword_t literals = c.care;
+            while(literals){
+                cword_t literal = literals & -literals;
+                literals ^= literal;
+                cube_t neighbour = {c.care, c.value ^ literal};
+                cubeset_add(p -> dirty, neighbour);
+            }
+        }
+    }
+
+    size_t size;
+    cube_t* cubes = cubeset_as_array(p -> dirty, &size);
+    for(size_t i = 0; i < size; i++){
+        if(primes_is_prime(p, variables - cube_literals(cubes[i]), cubes[i]))
+            cubeset_add(p -> primes, cubes[i]);
+        else
+            cubeset_remove(p -> primes, cubes[i]);
+    }
+}
+
+/**
+ * Stores in candidates the positions of the cubes of the level that may no longer be generated: at level 0
+ * the points of the changed cube (enumerated, or found scanning the level if it has fewer points), above it
+ * the supercubes with a free variable more of the affected cubes of the level below
+ * @param size Will store the number of positions, duplicates included
+ * @return false if the memory ran out
+ */
+bool primes_candidates(primes_t* p, unsigned level, cube_t changed, size_t* size){
+    *size = 0;
+    if(level > 0){
+        size_t affected_size;
+        cube_t* affected = cubeset_as_array(p -> affected, &affected_size);
+        for(size_t i = 0; i < affected_size; i++){
+            cword_t literals = affected[i].care;
+            while(literals){
+                cword_t literal = literals & -literals;
+                literals ^= literal;
+                cube_t super = {affected[i].care & ~literal, affected[i].value & ~literal};
+                if(!primes_candidate_add(p, level, super, size))
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    unsigned variables = p -> f -> variables;
+    cword_t free_vars = ~changed.care & CUBE_MASK(variables);
+    unsigned n_free = (unsigned) __builtin_popcountll(free_vars);
+    if(n_free < CWORD_BITS && ((size_t) 1 << n_free) <= cubeset_length(p -> levels[0])){
+        //each subset of the free variables is a point
+        cword_t subset = 0;
+        do{
+            if(!primes_candidate_add(p, 0, cube_of_point(changed.value | subset, variables), size))
+                return false;
+            subset = (subset - free_vars) & free_vars;
+        }while(subset != 0);
+    } else {
+        size_t level_size;
+        cube_t* cubes = cubeset_as_array(p -> levels[0], &level_size);
+        for(size_t i = 0; i < level_size; i++)
+            if(cube_intersects(cubes[i], changed) && !primes_candidate_add(p, 0, cubes[i], size))
+                return false;
+    }
+    return true;
+}
+
+/**
+ * Adds the position of the cube to the candidates, if it is in the level
+ * @param size The number of candidates, incremented if the cube is added
+ * @return false if the memory ran out
+ */
+bool primes_candidate_add(primes_t* p, unsigned level, cube_t c, size_t* size){
+    long position = cubeset_index_of(p -> levels[level], c);
+    if(position < 0)
+        return true;
+    if(*size == p -> candidates_max){
+        size_t new_max = p -> candidates_max == 0 ? CUBESET_INIT_SIZE : p -> candidates_max * 2;
+        REALLOC(p -> candidates, sizeof(size_t) * new_max, return false);
+        p -> candidates_max = new_max;
+    }
+    p -> candidates[(*size)++] = (size_t) position;
+    return true;
+}
+
+/**
+ * Orders the positions descending
+ */
+int primes_index_compare(const void* a, const void* b){
+    size_t x = *(const size_t*) a;
+    size_t y = *(const size_t*) b;
+    return x > y ? -1 : x < y;
+}
+
+/**
+ * @return true if two neighbour cubes of the given level can be joined,
+ *      two points are not joined if they are both don't care points
+ */
+bool primes_joinable(primes_t* p, unsigned level, cube_t low, cube_t high){
+    return level > 0 ||
+        !fplus_is_dont_care(p -> f, low.value) ||
+        !fplus_is_dont_care(p -> f, high.value);
+}
+
+/**
+ * @return true if the cube of the given level is still generated by Quine–McCluskey
+ *      with the current values of the function
+ */
+bool primes_generated(primes_t* p, unsigned level, cube_t c){
+    if(level == 0)
+        return fplus_value_at(p -> f, c.value) != 0;
+    cword_t free_vars = ~c.care & CUBE_MASK(p -> f -> variables);
+    while(free_vars){
+        cword_t literal = free_vars & -free_vars;
+        free_vars ^= literal;
+        cube_t low = {c.care | literal, c.value};
+        cube_t high = {c.care | literal, c.value | literal};
+        if(cubeset_contains(p -> levels[level - 1], low) && cubeset_contains(p -> levels[level - 1], high) &&
+            primes_joinable(p, level - 1, low, high))
+            return true;
+    }
+    return false;
+}
+
+/**
+ * A cube is prime if it is generated and has no generated neighbour to be joined with.
+ * Points covering only don't care values are not considered prime
+ * @return true if the cube of the given level is prime
+ */
+bool primes_is_prime(primes_t* p, unsigned level, cube_t c){
+    if(!cubeset_contains(p -> levels[level], c))
+        return false;
+    if(level == 0 && fplus_is_dont_care(p -> f, c.value))
+        return false;
+    cword_t literals = c.care;
+    while(literals){
+        cword_t literal = literals & -literals;
+        literals ^= literal;
+        cube_t neighbour = {c.care, c.value ^ literal};
+        if(cubeset_contains(p -> levels[level], neighbour))
+            return false;
+    }
+    return true;
+}
+
+/**
+ * @return A copy of the current prime implicants
+ */
+implicants_t* primes_implicants(primes_t* p){
+    implicants_t* implicants;
+    MALLOC(implicants, sizeof(implicants_t), ;);
+    size_t size;
+    cube_t* cubes = cubeset_as_array(p -> primes, &size);
+    implicants -> size = (int) size;
+    implicants -> variables = p -> f -> variables;
+    implicants -> cubes = NULL;
+    if(size > 0){
+        MALLOC(implicants -> cubes, sizeof(cube_t) * size, FREE(implicants));
+        memcpy(implicants -> cubes, cubes, sizeof(cube_t) * size);
+    }
+    return implicants;
+}
+
+/**
+ * @return The number of prime implicants
+ */
+size_t primes_length(primes_t* p){
+    NULL_CHECK(p);
+    return cubeset_length(p -> primes);
+}
+
+/**
+ * Frees the memory used, the function is not destroyed
+ */
+void primes_destroy(primes_t* p){
+    if(p != NULL){
+        for(unsigned l = 0; l <= p -> f -> variables; l++)
+            cubeset_destroy(p -> levels[l]);
+        FREE(p -> levels);
+        cubeset_destroy(p -> primes);
+        cubeset_destroy(p -> dirty);
+        cubeset_destroy(p -> affected);
+        FREE(p -> candidates);
+        FREE(p);
+    }
+}
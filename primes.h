@@ -0,0 +1,33 @@
+/*
+ * Library keeping the prime implicants of a boolean plus function up to date
+ * while its values are decreased. It stores every cube generated by Quine–McCluskey, so that
+ * after an update only the changed points and the cubes above the ones removed are checked again:
+ * the work is proportional to the cubes affected, not to all the cubes generated
+ */
+
+#ifndef DSOPP_SYNTHESIS_PRIMES_H
+#define DSOPP_SYNTHESIS_PRIMES_H
+
+#include "bool_plus.h"
+#include "cubeset.h"
+#include "budget.h"
+
+typedef struct{
+    fplus_t* f; //the function, its values are read at each update
+    cubeset_t** levels; //levels[l] has the cubes generated by Quine–McCluskey with l free variables
+    cubeset_t* primes; //the current prime implicants
+    cubeset_t* dirty; //cubes whose primality has to be checked again, used during the updates
+    cubeset_t* affected; //cubes removed from the last level checked by an update (or points become don't care)
+    size_t* candidates; //positions in a level of the cubes an update checks
+    size_t candidates_max; //size of above array
+}primes_t;
+
+primes_t* primes_create(fplus_t*); //generates the implicants of the function
+primes_t* primes_create_wbudget(fplus_t*, budget_t*); //same as above, NULL if the budget is over
+//updates the implicants after the values of the points covered by the cube were decreased
+void primes_update(primes_t*, cube_t changed);
+implicants_t* primes_implicants(primes_t*); //returns a copy of the current prime implicants
+size_t primes_length(primes_t*); //returns the number of prime implicants
+void primes_destroy(primes_t*); //frees the memory used
+
+#endif //DSOPP_SYNTHESIS_PRIMES_H
@@ -0,0 +1,49 @@
+#include <time.h>
+#include "prng.h"
+
+//internal functions
+uint64_t prng_splitmix(uint64_t* x);
+
+/**
+ * Initializes the generator, the same seed gives the same numbers
+ * @param g The generator
+ * @param seed The seed
+ */
+void prng_seed(prng_t* g, uint64_t seed){
+    prng_seed_wstream(g, seed, 0);
+}
+
+/**
+ * Initializes one of the generators of a seed: each stream gives different numbers, so that many
+ * generators can fill parts of the same data independently of the order in which they are filled
+ * @param g The generator
+ * @param seed The seed
+ * @param stream The number of the stream
+ */
+void prng_seed_wstream(prng_t* g, uint64_t seed, uint64_t stream){
+    uint64_t x = seed;
+    x = prng_splitmix(&x) ^ stream;
+    for(int i = 0; i < 4; i++)
+        g -> s[i] = prng_splitmix(&x);
+}
+
+/**
+ * @return A seed taken from the realtime clock
+ */
+uint64_t prng_clock_seed(){
+    struct timespec spec;
+    clock_gettime(CLOCK_REALTIME, &spec);
+    return (uint64_t) spec.tv_sec * 1000000000u + (uint64_t) spec.tv_nsec;
+}
+
+/**
+ * Advances the splitmix64 generator, used to spread the bits of a seed over the state
+ * @param x The state of the generator
+ * @return The next 64 bits
+ */
+uint64_t prng_splitmix(uint64_t* x){
+    uint64_t z = (*x += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
@@ -0,0 +1,41 @@
+/*
+ * Library implementing a seeded pseudo random generator (xoshiro256**) whose state belongs to the caller,
+ * so that it can be used by many threads at once and the same seed always gives the same numbers.
+ * The state is filled from the seed with splitmix64; a seed with different streams gives generators
+ * that can fill different parts of the same data in any order
+ */
+
+#ifndef DSOPP_SYNTHESIS_PRNG_H
+#define DSOPP_SYNTHESIS_PRNG_H
+
+#include <stdint.h>
+
+typedef struct{
+    uint64_t s[4];
+}prng_t;
+
+void prng_seed(prng_t*, uint64_t seed); //initializes the generator
+void prng_seed_wstream(prng_t*, uint64_t seed, uint64_t stream); //same as above, for one of many streams
+uint64_t prng_clock_seed(); //returns a seed taken from the clock, for runs that do not have to be repeated
+
+//returns the next 64 random bits
+static inline uint64_t prng_next(prng_t* g){
+    uint64_t* s = g -> s;
+    uint64_t x = s[1] * 5;
+    uint64_t result = ((x << 7) | (x >> 57)) * 9;
+    uint64_t t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = (s[3] << 45) | (s[3] >> 19);
+    return result;
+}
+
+//returns a random number in [0, bound), bound greater than 0
+static inline uint32_t prng_below(prng_t* g, uint32_t bound){
+    return (uint32_t) (((prng_next(g) >> 32) * bound) >> 32);
+}
+
+#endif //DSOPP_SYNTHESIS_PRNG_H
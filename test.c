@@ -6,11 +6,14 @@
 #include <assert.h>
 #include <string.h>
 #include "bool_plus.h"
+#include "batch.h"
 #include "utils.h"
 
 //max value for the boolean plus function output
 #define MAX_VALUE 10
 #define PROBABILITY_NON_ZERO_VALUE 50
+//number of non zero points of a sparse function
+#define SPARSE_NON_ZEROS 100000
 
 //types of tests available
 typedef enum {
@@ -20,16 +23,28 @@ typedef enum {
     sopp_time,
     dsopp_e_time,
     dsopp_time,
+    sopp_h,
+    sopp_h_time,
+    dsopp_h_time,
+    sopp_h_sparse_time,
+    dsopp_h_eval_time,
+    sopp_p_time,
+    dsopp_p_time,
+    sopp_b_time,
+    dsopp_b_time,
 }test_type;
 
 int main(int argc, char** argv) {
     if(argc < 3) {
-        printf("Usage: \"%s test_type n_variables [n_tests]\", available test types:\nsopp\ndsopp\n", argv[0]);
+        printf("Usage: \"%s test_type n_variables [n_tests] [seed]\", available test types:\nsopp\ndsopp\n", argv[0]);
         return 1;
     }
     long n_tests = 1;
     if(argc >= 4)
         n_tests = strtol(argv[3], NULL, 0);
+    //with a seed the i-th function is built from seed + i, so that a run can be repeated
+    bool seeded = argc >= 5;
+    uint64_t seed = seeded ? strtoull(argv[4], NULL, 0) : 0;
 
     //set type test once and for all
     test_type test;
@@ -53,15 +68,77 @@ int main(int argc, char** argv) {
     //of standard procedure
     else if(strcmp(argv[1], "dsopp_e_time") == 0)
         test = dsopp_e_time;
+    //test sopp heuristic: does sopp synthesis with the heuristic version and prints the form found
+    else if(strcmp(argv[1], "sopp_h") == 0)
+        test = sopp_h;
+    //test time of sopp heuristic: does sopp synthesis with the heuristic version
+    //then prints sum of weights of the form found
+    else if(strcmp(argv[1], "sopp_h_time") == 0)
+        test = sopp_h_time;
+    //test time dsopp heuristic: a dsopp time test where sopp_synthesis_heuristic is used instead
+    //of standard procedure
+    else if(strcmp(argv[1], "dsopp_h_time") == 0)
+        test = dsopp_h_time;
+    //test time of sopp heuristic on a sparse function with SPARSE_NON_ZEROS points (up to 64 variables)
+    else if(strcmp(argv[1], "sopp_h_sparse_time") == 0)
+        test = sopp_h_sparse_time;
+    //test time of batch evaluation: evaluates a heuristic dsopp form on all the points with sopp_values_at,
+    //checks the outputs against the function, then prints sum of weights of the form
+    else if(strcmp(argv[1], "dsopp_h_eval_time") == 0)
+        test = dsopp_h_eval_time;
+    //test time of portfolio: races the default engines and prints sum of weights of the lightest form found
+    else if(strcmp(argv[1], "sopp_p_time") == 0)
+        test = sopp_p_time;
+    //test time dsopp portfolio: a dsopp time test where the default engines race
+    else if(strcmp(argv[1], "dsopp_p_time") == 0)
+        test = dsopp_p_time;
+    //test time of batch: synthesizes all the functions at once on a thread for each processor,
+    //then prints sum of weights and time of each form found
+    else if(strcmp(argv[1], "sopp_b_time") == 0)
+        test = sopp_b_time;
+    //test time dsopp batch: a batch time test synthesizing dsopp forms
+    else if(strcmp(argv[1], "dsopp_b_time") == 0)
+        test = dsopp_b_time;
     else{
         fprintf(stderr, "Test type not recognised, please use one of the following:\nsopp\ndsopp\n");
         return 1;
     }
 
+    if(test == sopp_b_time || test == dsopp_b_time){
+        long variables = strtol(argv[2], NULL, 0);
+        fplus_t** functions;
+        MALLOC(functions, sizeof(fplus_t*) * n_tests, ;);
+        for(long i = 0; i < n_tests; i++) {
+            if(seeded)
+                functions[i] = fplus_create_random_wseed(variables, MAX_VALUE, PROBABILITY_NON_ZERO_VALUE, seed + i, 0);
+            else
+                functions[i] = fplus_create_random(variables, MAX_VALUE, PROBABILITY_NON_ZERO_VALUE);
+            assert(functions[i]);
+        }
+        batch_result_t* results = batch_synthesis(functions, n_tests, PORTFOLIO_GREEDY, test == dsopp_b_time, 0);
+        assert(results);
+        for(long i = 0; i < n_tests; i++) {
+            assert(results[i].form);
+            printf("%ld %f\n", sopp_weights_sum(results[i].form), results[i].seconds);
+            fplus_destroy(functions[i]);
+        }
+        batch_results_destroy(results, n_tests);
+        FREE(functions);
+        return 0;
+    }
+
     for(long i = 0; i < n_tests; i++) {
         long variables = strtol(argv[2], NULL, 0);
 
-        fplus_t *f = fplus_create_random(variables, MAX_VALUE, PROBABILITY_NON_ZERO_VALUE);
+        fplus_t *f;
+        if(test == sopp_h_sparse_time && seeded)
+            f = fplus_create_random_sparse_wseed(variables, MAX_VALUE, SPARSE_NON_ZEROS, seed + i);
+        else if(test == sopp_h_sparse_time)
+            f = fplus_create_random_sparse(variables, MAX_VALUE, SPARSE_NON_ZEROS);
+        else if(seeded)
+            f = fplus_create_random_wseed(variables, MAX_VALUE, PROBABILITY_NON_ZERO_VALUE, seed + i, 0);
+        else
+            f = fplus_create_random(variables, MAX_VALUE, PROBABILITY_NON_ZERO_VALUE);
         sopp_t *ds = NULL;
         switch(test){
             case sopp:
@@ -102,6 +179,67 @@ int main(int argc, char** argv) {
                 assert(ds);
                 printf("%ld\n", sopp_weights_sum(ds));
                 break;
+            case sopp_h:
+                assert(f);
+                fplus_print(f);
+                ds = sopp_synthesis_heuristic(f);
+                assert(ds);
+                sopp_print(ds);
+                break;
+            case sopp_h_time:
+                assert(f);
+                ds = sopp_synthesis_heuristic(f);
+                assert(ds);
+                printf("%ld\n", sopp_weights_sum(ds));
+                break;
+            case dsopp_h_time:
+                assert(f);
+                ds = dsopp_synthesis_wheuristic(f);
+                assert(ds);
+                printf("%ld\n", sopp_weights_sum(ds));
+                break;
+            case sopp_h_sparse_time:
+                assert(f);
+                ds = sopp_synthesis_heuristic(f);
+                assert(ds);
+                printf("%ld\n", sopp_weights_sum(ds));
+                break;
+            case dsopp_h_eval_time: {
+                assert(f);
+                ds = dsopp_synthesis_wheuristic(f);
+                assert(ds);
+                size_t size = (size_t) 1 << variables;
+                point_t* points;
+                long* sums;
+                MALLOC(points, sizeof(point_t) * size, ;);
+                MALLOC(sums, sizeof(long) * size, FREE(points));
+                for(size_t p = 0; p < size; p++)
+                    points[p] = p;
+                bool done = sopp_values_at(ds, points, variables, size, sums);
+                assert(done);
+                for(size_t p = 0; p < size; p++)
+                    assert(sums[p] == fplus_value_at(f, p));
+                printf("%ld\n", sopp_weights_sum(ds));
+                FREE(points);
+                FREE(sums);
+                break;
+            }
+            case sopp_p_time:
+                assert(f);
+                ds = sopp_synthesis_portfolio(f, PORTFOLIO_DEFAULT, 0);
+                assert(ds);
+                printf("%ld\n", sopp_weights_sum(ds));
+                break;
+            case dsopp_p_time:
+                assert(f);
+                ds = dsopp_synthesis_portfolio(f, PORTFOLIO_DEFAULT, 0);
+                assert(ds);
+                printf("%ld\n", sopp_weights_sum(ds));
+                break;
+            case sopp_b_time:
+            case dsopp_b_time:
+                //run as a batch above
+                break;
         }
         fplus_destroy(f);
         sopp_destroy(ds);